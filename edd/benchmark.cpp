@@ -0,0 +1,551 @@
+/*
+ * benchmark.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// micro-benchmarks for the brain, game and reproduction kernels. built by
+// build_benchmark as a separate program; results are printed and written to
+// a json file so builds can be compared.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <functional>
+#include <chrono>
+
+#include "globalConst.h"
+#include "tHMM.h"
+#include "tAgent.h"
+#include "tGame.h"
+#include "tDataset.h"
+#include "tNative.h"
+
+using namespace std;
+
+struct tBenchmarkResult
+{
+    string name, parameters;
+    double median, mean, stddev, minimum, maximum;
+    int samples;
+    long long iterations;
+};
+
+static vector<tBenchmarkResult> results;
+static string benchmarkFilter = "";
+static int benchmarkSamples = 15;
+static double sampleSeconds = 0.02;
+
+static double secondsSince(chrono::steady_clock::time_point start)
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// runs body until it has warmed up, picks an iteration count that takes about
+// sampleSeconds, then times benchmarkSamples samples of that many iterations.
+// times are reported in nanoseconds per call of body.
+static void measure(const string &name, const string &parameters, function<void()> body)
+{
+    string fullName = name + " " + parameters;
+
+    if (benchmarkFilter != "" && fullName.find(benchmarkFilter) == string::npos)
+    {
+        return;
+    }
+
+    // warm up and calibrate
+    long long iterations = 1;
+
+    while (true)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        for (long long i = 0; i < iterations; ++i)
+        {
+            body();
+        }
+
+        double elapsed = secondsSince(start);
+
+        if (elapsed >= sampleSeconds || iterations >= (1LL << 40))
+        {
+            break;
+        }
+
+        iterations *= (elapsed < sampleSeconds / 16.0) ? 8 : 2;
+    }
+
+    vector<double> times;
+
+    for (int sample = 0; sample < benchmarkSamples; ++sample)
+    {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+        for (long long i = 0; i < iterations; ++i)
+        {
+            body();
+        }
+
+        times.push_back(secondsSince(start) * 1e9 / (double)iterations);
+    }
+
+    sort(times.begin(), times.end());
+
+    tBenchmarkResult result;
+    result.name = name;
+    result.parameters = parameters;
+    result.samples = (int)times.size();
+    result.iterations = iterations;
+    result.minimum = times.front();
+    result.maximum = times.back();
+    result.median = (times.size() % 2 == 1) ? times[times.size() / 2] : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2.0;
+    result.mean = 0.0;
+
+    for (int i = 0; i < times.size(); ++i)
+    {
+        result.mean += times[i];
+    }
+
+    result.mean /= (double)times.size();
+    result.stddev = 0.0;
+
+    for (int i = 0; i < times.size(); ++i)
+    {
+        result.stddev += (times[i] - result.mean) * (times[i] - result.mean);
+    }
+
+    result.stddev = sqrt(result.stddev / (double)times.size());
+    results.push_back(result);
+
+    printf("%-22s %-28s %14.1f ns  (+/- %.1f%%)\n", name.c_str(), parameters.c_str(), result.median,
+           (result.mean > 0.0) ? 100.0 * result.stddev / result.mean : 0.0);
+    fflush(stdout);
+}
+
+// random genome with a gate of the given number of inputs and outputs at the start
+static void setupGateGenome(vector<unsigned char> &genome, int inputs, int outputs)
+{
+    genome.resize(300);
+
+    for (int i = 0; i < genome.size(); ++i)
+    {
+        genome[i] = eddRand() & 255;
+    }
+
+    genome[0] = 42;
+    genome[1] = 255 - 42;
+    genome[2] = (unsigned char)((genome[2] & ~3) | (outputs - 1));
+    genome[3] = (unsigned char)((genome[3] & ~3) | (inputs - 1));
+}
+
+// random genome with exactly the given number of gates
+static void setupBrainGenome(tAgent &agent, int gates)
+{
+    agent.genome.resize(5000 + gates * 40);
+
+    for (int i = 0; i < agent.genome.size(); ++i)
+    {
+        agent.genome[i] = eddRand() & 255;
+
+        // no accidental start codons
+        if (agent.genome[i] == 42)
+        {
+            agent.genome[i] = 41;
+        }
+    }
+
+    int spacing = (int)agent.genome.size() / gates;
+
+    for (int gate = 0; gate < gates; ++gate)
+    {
+        agent.genome[gate * spacing] = 42;
+        agent.genome[gate * spacing + 1] = 255 - 42;
+    }
+
+    agent.setupPhenotype();
+}
+
+static void writeJSON(const char *filename)
+{
+    FILE *f = fopen(filename, "w");
+
+    if (f == NULL)
+    {
+        perror(filename);
+        return;
+    }
+
+    char date[64];
+    time_t now = time(NULL);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+
+    fprintf(f, "{\n  \"benchmark\": \"edd kernels\",\n  \"date\": \"%s\",\n", date);
+#ifdef __VERSION__
+    fprintf(f, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(f, "  \"unit\": \"ns\",\n  \"results\": [\n");
+
+    for (int i = 0; i < results.size(); ++i)
+    {
+        tBenchmarkResult &r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"parameters\": \"%s\", \"median\": %.3f, \"mean\": %.3f, \"stddev\": %.3f, "
+                   "\"min\": %.3f, \"max\": %.3f, \"samples\": %d, \"iterations\": %lld}%s\n",
+                r.name.c_str(), r.parameters.c_str(), r.median, r.mean, r.stddev, r.minimum, r.maximum, r.samples,
+                r.iterations, (i + 1 < results.size()) ? "," : "");
+    }
+
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+
+    cout << "wrote " << results.size() << " result(s) to " << filename << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    string genomeFileName = "gene.genome", outputFileName = "benchmark.json", nativeDirectory = "edd-native";
+    string datasetFileName;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        // -genome [in file name]: evolved genome used by the phenotype, inherit and game benchmarks
+        if (strcmp(argv[i], "-genome") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            genomeFileName = argv[i];
+        }
+
+        // -o [out file name]: json results file
+        else if (strcmp(argv[i], "-o") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            outputFileName = argv[i];
+        }
+
+        // -filter [text]: only run benchmarks whose name contains the text
+        else if (strcmp(argv[i], "-filter") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            benchmarkFilter = argv[i];
+        }
+
+        // -native [cache directory]: where the native code benchmarks cache their brains
+        else if (strcmp(argv[i], "-native") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            nativeDirectory = argv[i];
+        }
+
+        // -dataset [dataset file name]: also time games on images from the given dataset
+        else if (strcmp(argv[i], "-dataset") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            datasetFileName = argv[i];
+        }
+
+        // -quick: fewer and shorter samples
+        else if (strcmp(argv[i], "-quick") == 0)
+        {
+            benchmarkSamples = 5;
+            sampleSeconds = 0.005;
+        }
+    }
+
+    eddSrand(1);
+
+    tAgent evolved;
+    evolved.loadAgent((char *)genomeFileName.c_str());
+
+    // tHMMU::update for each number of inputs
+    for (int inputs = 1; inputs <= 4; ++inputs)
+    {
+        vector<unsigned char> genome;
+        setupGateGenome(genome, inputs, 2);
+
+        tHMMU gate;
+        gate.setupDeterministic(genome, 0);
+
+        unsigned char states[maxNodes], newStates[maxNodes];
+
+        for (int i = 0; i < maxNodes; ++i)
+        {
+            states[i] = eddRand() & 1;
+            newStates[i] = 0;
+        }
+
+        char parameters[64];
+        snprintf(parameters, sizeof(parameters), "inputs=%d", inputs);
+        measure("hmmu_update", parameters, [&]()
+        {
+            gate.update(states, newStates);
+            states[gate.ins[0]] ^= 1;
+        });
+    }
+
+    // tAgent::updateStates for several brain sizes
+    int gateCounts[] = { 4, 16, 64, 256 };
+
+    for (int g = 0; g < 4; ++g)
+    {
+        tAgent agent;
+        setupBrainGenome(agent, gateCounts[g]);
+
+        for (int i = 0; i < 9; ++i)
+        {
+            agent.states[i] = eddRand() & 1;
+        }
+
+        char parameters[64];
+        snprintf(parameters, sizeof(parameters), "gates=%d", (int)agent.hmmus.size());
+        measure("update_states", parameters, [&]()
+        {
+            agent.updateStates();
+        });
+
+        // event driven, with one sensor changing every step
+        eventDrivenBrains = true;
+        agent.setupPhenotype();
+        measure("update_states_events", parameters, [&]()
+        {
+            agent.updateStates();
+            agent.states[0] ^= 1;
+        });
+
+        // and with its gates fused
+        fuseEventGates = true;
+        agent.setupPhenotype();
+        measure("update_states_fused", parameters, [&]()
+        {
+            agent.updateStates();
+            agent.states[0] ^= 1;
+        });
+        eventDrivenBrains = false;
+        fuseEventGates = false;
+        agent.setupPhenotype();
+
+        // the same brain as minimized logic
+        agent.compileLogic();
+        measure("update_states_logic", parameters, [&]()
+        {
+            agent.updateStates();
+        });
+
+        // and as native code
+        if (compileNative(&agent, nativeDirectory))
+        {
+            measure("update_states_native", parameters, [&]()
+            {
+                agent.updateStates();
+            });
+        }
+    }
+
+    // setupPhenotype on a fresh random agent and on the evolved genome
+    {
+        tAgent fresh;
+        fresh.setupRandomAgent(10000);
+        measure("setup_phenotype", "random_agent", [&]()
+        {
+            fresh.setupPhenotype();
+        });
+
+        measure("setup_phenotype", genomeFileName.substr(genomeFileName.rfind('/') + 1), [&]()
+        {
+            evolved.setupPhenotype();
+        });
+    }
+
+    // tAgent::inherit at several mutation rates
+    double mutationRates[] = { 0.0005, 0.005, 0.05 };
+
+    for (int m = 0; m < 3; ++m)
+    {
+        char parameters[64];
+        snprintf(parameters, sizeof(parameters), "rate=%g", mutationRates[m]);
+        measure("inherit", parameters, [&]()
+        {
+            tAgent *offspring = new tAgent;
+            offspring->inherit(&evolved, mutationRates[m], 1, false);
+            delete offspring;
+        });
+    }
+
+    // a whole game of the evolved agent under each option
+    struct tGameOptions
+    {
+        const char *name;
+        int gridSizeX, gridSizeY;
+        bool zoomingCamera, randomPlacement, noise;
+    } gameOptions[] =
+    {
+        { "default", 5, 5, false, false, false },
+        { "-zc", 5, 5, true, false, false },
+        { "-rp -gs 9 9", 9, 9, false, true, false },
+        { "-noise 0.05", 5, 5, false, false, true },
+        { "-gs 25 25", 25, 25, false, false, false },
+        { "-zc -rp -gs 25 25", 25, 25, true, true, false },
+    };
+
+    tGame game;
+
+    for (int o = 0; o < sizeof(gameOptions) / sizeof(gameOptions[0]); ++o)
+    {
+        tGameOptions &options = gameOptions[o];
+        measure("execute_game", options.name, [&]()
+        {
+            game.executeGame(&evolved, NULL, false, options.gridSizeX, options.gridSizeY, options.zoomingCamera,
+                             options.randomPlacement, options.noise, 0.05);
+        });
+    }
+
+    // and in wider brains, where the same genome builds a different brain
+    int widths[] = { 128, 256 };
+
+    for (int w = 0; w < 2; ++w)
+    {
+        char parameters[64];
+        snprintf(parameters, sizeof(parameters), "-nodes %d", widths[w]);
+        brainNodes = widths[w];
+        measure("execute_game", parameters, [&]()
+        {
+            game.executeGame(&evolved, NULL, false, 5, 5, false, false, false, 0.05);
+        });
+    }
+
+    brainNodes = 64;
+
+    // and on random variants of the digits, from a cache kept across games
+    game.setAugmentation(4096);
+    measure("execute_game", "-augment 4096 -zc -rp -gs 9 9", [&]()
+    {
+        game.executeGame(&evolved, NULL, false, 9, 9, true, true, false, 0.05);
+    });
+    game.setAugmentation(0);
+
+    // and with pooled retinas, which can zoom out to the whole grid
+    game.retinaPooling = poolAny;
+    measure("execute_game", "-pool any 3 -zc -rp -gs 25 25", [&]()
+    {
+        game.executeGame(&evolved, NULL, false, 25, 25, true, true, false, 0.05);
+    });
+    game.retinaPooling = poolMajority;
+    game.retinaSize = 5;
+    measure("execute_game", "-pool majority 5 -zc -rp -gs 64 64", [&]()
+    {
+        game.executeGame(&evolved, NULL, false, 64, 64, true, true, false, 0.05);
+    });
+    game.retinaPooling = poolNone;
+    game.retinaSize = 3;
+
+    // and on dataset images, on a grid just large enough for them
+    if (datasetFileName != "")
+    {
+        const tDataset *dataset = tDataset::shared(datasetFileName.c_str());
+
+        if (dataset != NULL)
+        {
+            char parameters[64];
+            snprintf(parameters, sizeof(parameters), "-dataset -zc -rp -gs %d %d", dataset->width(), dataset->height());
+            game.dataset = dataset;
+            measure("execute_game", parameters, [&]()
+            {
+                game.executeGame(&evolved, NULL, false, dataset->width(), dataset->height(), true, true, false, 0.05);
+            });
+
+            if (game.setAugmentation(4096))
+            {
+                snprintf(parameters, sizeof(parameters), "-dataset -augment 4096 -zc -rp -gs %d %d", dataset->width(), dataset->height());
+                measure("execute_game", parameters, [&]()
+                {
+                    game.executeGame(&evolved, NULL, false, dataset->width(), dataset->height(), true, true, false, 0.05);
+                });
+                game.setAugmentation(0);
+            }
+
+            game.dataset = NULL;
+        }
+    }
+
+    // the evolved agent's games with event driven brain updates
+    eventDrivenBrains = true;
+    evolved.setupPhenotype();
+
+    for (int o = 0; o < sizeof(gameOptions) / sizeof(gameOptions[0]); ++o)
+    {
+        tGameOptions &options = gameOptions[o];
+        measure("execute_game_events", options.name, [&]()
+        {
+            game.executeGame(&evolved, NULL, false, options.gridSizeX, options.gridSizeY, options.zoomingCamera,
+                             options.randomPlacement, options.noise, 0.05);
+        });
+    }
+
+    // and with its gates fused
+    fuseEventGates = true;
+    evolved.setupPhenotype();
+
+    for (int o = 0; o < sizeof(gameOptions) / sizeof(gameOptions[0]); ++o)
+    {
+        tGameOptions &options = gameOptions[o];
+        measure("execute_game_fused", options.name, [&]()
+        {
+            game.executeGame(&evolved, NULL, false, options.gridSizeX, options.gridSizeY, options.zoomingCamera,
+                             options.randomPlacement, options.noise, 0.05);
+        });
+    }
+
+    eventDrivenBrains = false;
+    fuseEventGates = false;
+
+    // the evolved agent's games with its brain compiled to minimized logic
+    evolved.setupPhenotype();
+    evolved.compileLogic();
+
+    for (int o = 0; o < sizeof(gameOptions) / sizeof(gameOptions[0]); ++o)
+    {
+        tGameOptions &options = gameOptions[o];
+        measure("execute_game_logic", options.name, [&]()
+        {
+            game.executeGame(&evolved, NULL, false, options.gridSizeX, options.gridSizeY, options.zoomingCamera,
+                             options.randomPlacement, options.noise, 0.05);
+        });
+    }
+
+    // and compiled to native code
+    if (compileNative(&evolved, nativeDirectory))
+    {
+        for (int o = 0; o < sizeof(gameOptions) / sizeof(gameOptions[0]); ++o)
+        {
+            tGameOptions &options = gameOptions[o];
+            measure("execute_game_native", options.name, [&]()
+            {
+                game.executeGame(&evolved, NULL, false, options.gridSizeX, options.gridSizeY, options.zoomingCamera,
+                                 options.randomPlacement, options.noise, 0.05);
+            });
+        }
+    }
+
+    writeJSON(outputFileName.c_str());
+
+    return 0;
+}
@@ -0,0 +1,488 @@
+/*
+ * difftest.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// differential tests of the production brain and game against the reference
+// engine in tReference.cpp. built by build_difftest as a separate program.
+// every gate, brain and game is run by both engines from the same random
+// number generator state, and the two must agree exactly: the states after
+// every step, the fitness, the confusion counts and the random numbers used.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include "globalConst.h"
+#include "tHMM.h"
+#include "tAgent.h"
+#include "tGame.h"
+#include "tRandom.h"
+#include "tReference.h"
+#include "tDataset.h"
+
+using namespace std;
+
+struct tGameOptions
+{
+    const char *name;
+    int gridSizeX, gridSizeY;
+    bool zoomingCamera, randomPlacement, noise;
+    int totalSteps;
+    bool readyActuator;
+    double speedBonus;
+    int nodes;
+    bool dataset;
+    int batch;
+    int augment;
+    int pooling, retinaSize;
+};
+
+static const tGameOptions gameOptions[] =
+{
+    { "default", 5, 5, false, false, false, 20, false, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-zc", 5, 5, true, false, false, 20, false, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-rp -gs 9 9", 9, 9, false, true, false, 20, false, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-zc -rp -gs 9 9", 9, 9, true, true, false, 20, false, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-noise 0.05", 5, 5, false, false, true, 20, false, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-zc -rp -gs 25 25", 25, 25, true, true, false, 20, false, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-steps 40 -ready", 5, 5, false, false, false, 40, true, 0.0, 64, false, 0, 0, poolNone, 3 },
+    { "-zc -steps 12 -speed 0.5", 5, 5, true, false, false, 12, true, 0.5, 64, false, 0, 0, poolNone, 3 },
+    { "-nodes 128 -zc -gs 9 9", 9, 9, true, false, false, 20, false, 0.0, 128, false, 0, 0, poolNone, 3 },
+    { "-nodes 256 -zc -rp -gs 25 25 -ready", 25, 25, true, true, false, 20, true, 0.0, 256, false, 0, 0, poolNone, 3 },
+    { "-dataset (11x7 images) -gs 11 11", 11, 11, false, false, false, 20, false, 0.0, 64, true, 0, 0, poolNone, 3 },
+    { "-nodes 128 -dataset (11x7 images) -zc -rp -gs 16 12 -ready", 16, 12, true, true, false, 20, true, 0.0, 128, true, 0, 0, poolNone, 3 },
+    { "-dataset (11x7 images) -batch 3 -zc -gs 13 9", 13, 9, true, false, false, 20, false, 0.0, 64, true, 3, 0, poolNone, 3 },
+    { "-augment 4096 -zc -rp -gs 9 9", 9, 9, true, true, false, 20, false, 0.0, 64, false, 0, 4096, poolNone, 3 },
+    { "-dataset (11x7 images) -augment 16 -gs 11 11 -ready", 11, 11, false, false, false, 20, true, 0.0, 64, true, 0, 16, poolNone, 3 },
+    { "-pool any 3 -zc -rp -gs 25 25", 25, 25, true, true, false, 20, false, 0.0, 64, false, 0, 0, poolAny, 3 },
+    { "-pool majority 5 -dataset (11x7 images) -zc -rp -gs 16 12", 16, 12, true, true, false, 20, false, 0.0, 64, true, 0, 0, poolMajority, 5 },
+    { "-pool any 1 -zc -steps 30 -gs 9 9", 9, 9, true, false, false, 30, false, 0.0, 64, false, 0, 0, poolAny, 1 },
+};
+
+#define numGameOptions (int)(sizeof(gameOptions) / sizeof(gameOptions[0]))
+
+static tGame *game = NULL;
+static tDataset *dataset = NULL;
+
+static bool sameRandomState(const tRandomState &a, const tRandomState &b)
+{
+    return memcmp(&a, &b, sizeof(tRandomState)) == 0;
+}
+
+// runs one gate of the genome, starting at start, through both engines.
+// returns a description of the first difference, or "" if there is none.
+static string compareGate(vector<unsigned char> &genome, int start, unsigned char *states)
+{
+    tHMMU gate;
+    tReferenceGate reference;
+    gate.setupDeterministic(genome, start);
+    reference.setup(genome, start);
+    
+    unsigned char newStates[maxNodes], referenceNewStates[maxNodes];
+    memset(newStates, 0, sizeof(newStates));
+    memset(referenceNewStates, 0, sizeof(referenceNewStates));
+    
+    tRandomState before, after, referenceAfter;
+    eddGetRandomState(before);
+    gate.update(states, newStates);
+    eddGetRandomState(after);
+    eddSetRandomState(before);
+    reference.update(states, referenceNewStates);
+    eddGetRandomState(referenceAfter);
+    
+    for (int node = 0; node < brainNodes; ++node)
+    {
+        if (newStates[node] != referenceNewStates[node])
+        {
+            stringstream difference;
+            difference << "node " << node << " is " << (int)newStates[node] << ", reference " << (int)referenceNewStates[node];
+            return difference.str();
+        }
+    }
+    
+    if (!sameRandomState(after, referenceAfter))
+    {
+        return "different random numbers used";
+    }
+    
+    return "";
+}
+
+// how edd runs the brain: its gates, its minimized logic (-compile),
+// event-driven (-events) or event-driven with fused gates (-fuse)
+enum tBrainEngine
+{
+    engineGates, engineLogic, engineEvents, engineFused, brainEngines
+};
+
+static const char *engineNames[brainEngines] = { "", ", compiled", ", events", ", fused" };
+
+// plays the genome with both engines from the same seed, with edd's brain run
+// by the given engine. returns a description of the first difference, or ""
+// if there is none.
+static string compareGame(const vector<unsigned char> &genome, const tGameOptions &options, unsigned int seed, int engine)
+{
+    tAgent agent;
+    agent.genome = genome;
+    brainNodes = options.nodes;
+    eventDrivenBrains = (engine == engineEvents || engine == engineFused);
+    fuseEventGates = (engine == engineFused);
+    
+    if (engine == engineLogic)
+    {
+        agent.setupPhenotype();
+        agent.compileLogic();
+    }
+    
+    vector<unsigned char> trace, referenceTrace;
+    tRandomState after, referenceAfter;
+    
+    eddSrand(seed);
+    game->totalSteps = options.totalSteps;
+    game->readyActuator = options.readyActuator;
+    game->speedBonus = options.speedBonus;
+    game->dataset = options.dataset ? dataset : NULL;
+    game->setAugmentation(options.augment);
+    game->retinaPooling = options.pooling;
+    game->retinaSize = options.retinaSize;
+    
+    // a different minibatch for every seed
+    vector<uint32_t> batch;
+    
+    if (options.batch > 0)
+    {
+        dataset->minibatch(options.batch, seed, seed % 7, batch);
+    }
+    
+    game->batch = (options.batch > 0) ? &batch : NULL;
+    game->stateTrace = &trace;
+    game->executeGame(&agent, NULL, false, options.gridSizeX, options.gridSizeY, options.zoomingCamera,
+                      options.randomPlacement, options.noise, 0.05);
+    game->stateTrace = NULL;
+    eddGetRandomState(after);
+    
+    tReferenceResult result;
+    eddSrand(seed);
+    referenceExecuteGame(genome, options.gridSizeX, options.gridSizeY, options.zoomingCamera, options.randomPlacement,
+                         options.noise, 0.05, options.totalSteps, options.readyActuator, options.speedBonus,
+                         options.dataset ? dataset : NULL, (options.batch > 0) ? &batch : NULL, options.augment > 0,
+                         options.pooling, options.retinaSize, result, &referenceTrace);
+    eddGetRandomState(referenceAfter);
+    
+    stringstream difference;
+    
+    for (size_t i = 0; i < min(trace.size(), referenceTrace.size()); ++i)
+    {
+        if (trace[i] != referenceTrace[i])
+        {
+            difference << "brain step " << i / brainNodes + 1 << " of the game: node " << i % brainNodes
+                       << " is " << (int)trace[i] << ", reference " << (int)referenceTrace[i];
+            return difference.str();
+        }
+    }
+    
+    if (trace.size() != referenceTrace.size())
+    {
+        difference << trace.size() / brainNodes << " steps, reference " << referenceTrace.size() / brainNodes;
+        return difference.str();
+    }
+    
+    if (agent.fitness != result.fitness || agent.classificationFitness != result.classificationFitness ||
+        agent.savedSteps != result.savedSteps)
+    {
+        difference << "fitness " << agent.fitness << " (" << agent.savedSteps << " steps saved), reference " << result.fitness
+                   << " (" << result.savedSteps << ")";
+        return difference.str();
+    }
+    
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        if (agent.truePositives[digit] != result.truePositives[digit] || agent.falsePositives[digit] != result.falsePositives[digit] ||
+            agent.trueNegatives[digit] != result.trueNegatives[digit] || agent.falseNegatives[digit] != result.falseNegatives[digit])
+        {
+            difference << "confusion counts of digit " << digit << " differ";
+            return difference.str();
+        }
+    }
+    
+    if (!sameRandomState(after, referenceAfter))
+    {
+        return "different random numbers used";
+    }
+    
+    return "";
+}
+
+// a dataset of random 11x7 images, a few of each digit. they are not square so
+// that swapped rows and columns show up.
+static tDataset *makeDataset(void)
+{
+    const int count = 40, width = 11, height = 7;
+    string imagesFile = "difftest-images.idx", labelsFile = "difftest-labels.idx", datasetFile = "difftest-dataset.edd";
+    
+    FILE *images = fopen(imagesFile.c_str(), "wb");
+    FILE *labels = fopen(labelsFile.c_str(), "wb");
+    
+    if (images == NULL || labels == NULL)
+    {
+        perror("difftest dataset");
+        return NULL;
+    }
+    
+    const unsigned char imagesHeader[16] = { 0, 0, 8, 3, 0, 0, 0, count, 0, 0, 0, height, 0, 0, 0, width };
+    const unsigned char labelsHeader[8] = { 0, 0, 8, 1, 0, 0, 0, count };
+    fwrite(imagesHeader, 1, sizeof(imagesHeader), images);
+    fwrite(labelsHeader, 1, sizeof(labelsHeader), labels);
+    
+    for (int i = 0; i < count; ++i)
+    {
+        fputc(i % 10, labels);
+        
+        for (int pixel = 0; pixel < width * height; ++pixel)
+        {
+            fputc(eddRand() & 255, images);
+        }
+    }
+    
+    fclose(images);
+    fclose(labels);
+    
+    tDataset *made = new tDataset;
+    
+    if (!tDataset::convert(imagesFile.c_str(), labelsFile.c_str(), 128, datasetFile.c_str()) || !made->open(datasetFile.c_str()))
+    {
+        delete made;
+        made = NULL;
+    }
+    
+    // the mapping outlives the file
+    remove(imagesFile.c_str());
+    remove(labelsFile.c_str());
+    remove(datasetFile.c_str());
+    
+    return made;
+}
+
+// removes ever smaller pieces of the genome for as long as the engines still
+// disagree on it, and returns what is left
+static vector<unsigned char> minimizeGenome(vector<unsigned char> genome, const tGameOptions &options, unsigned int seed,
+                                            int engine)
+{
+    for (int chunk = (int)genome.size() / 2; chunk >= 1; chunk /= 2)
+    {
+        for (int start = 0; start < (int)genome.size() && genome.size() > 2; )
+        {
+            vector<unsigned char> smaller(genome.begin(), genome.begin() + start);
+            smaller.insert(smaller.end(), genome.begin() + min(start + chunk, (int)genome.size()), genome.end());
+            
+            if (smaller.size() >= 2 && compareGame(smaller, options, seed, engine) != "")
+            {
+                genome.swap(smaller);
+            }
+            else
+            {
+                start += chunk;
+            }
+        }
+    }
+    
+    return genome;
+}
+
+// random bytes with the given number of gates, and no other start codons
+static void setupDenseGenome(vector<unsigned char> &genome, int gates)
+{
+    genome.resize(1000 + gates * 40);
+    
+    for (int i = 0; i < genome.size(); ++i)
+    {
+        genome[i] = eddRand() & 255;
+        
+        if (genome[i] == 42)
+        {
+            genome[i] = 41;
+        }
+    }
+    
+    int spacing = (int)genome.size() / gates;
+    
+    for (int gate = 0; gate < gates; ++gate)
+    {
+        genome[gate * spacing] = 42;
+        genome[gate * spacing + 1] = 255 - 42;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    string genomeFileName = "gene.genome", failurePrefix = "difftest-failure";
+    int cases = 100;
+    unsigned int seed = 1;
+    
+    for (int i = 1; i < argc; ++i)
+    {
+        // -genome [in file name]: evolved genome; it and mutants of it are tested
+        if (strcmp(argv[i], "-genome") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            genomeFileName = argv[i];
+        }
+        
+        // -cases [int]: number of genomes of each kind to test
+        else if (strcmp(argv[i], "-cases") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            cases = atoi(argv[i]);
+        }
+        
+        // -s [int]: seed for the genomes and environments
+        else if (strcmp(argv[i], "-s") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            seed = atoi(argv[i]);
+        }
+        
+        // -o [out file prefix]: minimized failing genomes are saved as [prefix]-[int].genome
+        else if (strcmp(argv[i], "-o") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            failurePrefix = argv[i];
+        }
+    }
+    
+    eddSrand(seed);
+    game = new tGame;
+    dataset = makeDataset();
+    
+    if (dataset == NULL)
+    {
+        return 1;
+    }
+    
+    tAgent evolved;
+    evolved.loadAgent((char *)genomeFileName.c_str());
+    
+    int failures = 0, savedGenomes = 0, gatesTested = 0, gamesTested = 0;
+    
+    // single gates of every shape on random states, in brains of every width
+    for (int test = 0; test < cases * 10; ++test)
+    {
+        brainNodes = 64 << (test % 3);
+        vector<unsigned char> genome(64);
+        unsigned char states[maxNodes];
+        
+        for (int i = 0; i < genome.size(); ++i)
+        {
+            genome[i] = eddRand() & 255;
+        }
+        
+        for (int i = 0; i < maxNodes; ++i)
+        {
+            states[i] = eddRand() & 1;
+        }
+        
+        string difference = compareGate(genome, 0, states);
+        ++gatesTested;
+        
+        if (difference != "")
+        {
+            cout << "gate " << test << ": " << difference << endl;
+            ++failures;
+        }
+    }
+    
+    // whole games with random, dense, evolved and mutated evolved genomes
+    for (int test = 0; test < cases; ++test)
+    {
+        tAgent agent;
+        const char *kind;
+        
+        switch (test % 4)
+        {
+            case 0:
+                kind = "random";
+                agent.setupRandomAgent(5000);
+                break;
+                
+            case 1:
+                kind = "dense";
+                setupDenseGenome(agent.genome, 1 + eddRand() % 128);
+                break;
+                
+            case 2:
+                kind = "evolved";
+                agent.genome = evolved.genome;
+                break;
+                
+            default:
+                kind = "mutated";
+                tAgent *mutant = new tAgent;
+                mutant->inherit(&evolved, (test % 8 == 3) ? 0.005 : 0.05, 1, false);
+                agent.genome = mutant->genome;
+                delete mutant;
+                break;
+        }
+        
+        for (int o = 0; o < numGameOptions * brainEngines; ++o)
+        {
+            const tGameOptions &options = gameOptions[o / brainEngines];
+            int engine = o % brainEngines;
+            unsigned int gameSeed = (unsigned int)eddRand();
+            tRandomState state;
+            eddGetRandomState(state);
+            
+            string difference = compareGame(agent.genome, options, gameSeed, engine);
+            ++gamesTested;
+            
+            if (difference != "")
+            {
+                ++failures;
+                cout << "game " << test << " (" << kind << " genome, " << options.name << engineNames[engine]
+                     << ", seed " << gameSeed << "): " << difference << endl;
+                
+                vector<unsigned char> minimal = minimizeGenome(agent.genome, options, gameSeed, engine);
+                
+                tAgent failing;
+                failing.genome = minimal;
+                failing.setupPhenotype();
+                
+                stringstream fileName;
+                fileName << failurePrefix << "-" << ++savedGenomes << ".genome";
+                failing.saveGenome(fileName.str().c_str());
+                
+                cout << "    minimized to " << minimal.size() << " byte(s) and " << failing.hmmus.size() << " gate(s), saved as " << fileName.str()
+                     << ": " << compareGame(minimal, options, gameSeed, engine) << endl;
+            }
+            
+            eddSetRandomState(state);
+        }
+    }
+    
+    cout << gatesTested << " gate(s) and " << gamesTested << " game(s) compared, " << failures << " difference(s)" << endl;
+    
+    delete game;
+    delete dataset;
+    
+    return (failures == 0) ? 0 : 1;
+}
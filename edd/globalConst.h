@@ -22,8 +22,80 @@
 #ifndef _globalConst_h_included_
 #define _globalConst_h_included_
 
+#include "tRandom.h"
+#include <stdint.h>
+#include <string.h>
+
 #define     cPI             3.14159265
-#define     randDouble      ((double)rand() / (double)RAND_MAX)
-#define     maxNodes        64
+#define     randDouble      ((double)eddRand() / (double)RAND_MAX)
+
+// state arrays hold the widest brain
+#define     maxNodes        256
+
+// nodes in the brains of this thread's run: 64 (the default), 128 or 256
+// (-nodes). gates read genome bytes masked to the width, and the actuators are
+// the last nodes, so the width decides what brain a genome builds.
+extern thread_local int brainNodes;
+
+// what is specific to one brain width: the mask that turns a genome byte into
+// a node, the nodes left for sensors in front of the 27 actuators, and the
+// states packed 64 nodes to a word (node i is bit i % 64 of word i / 64).
+// states are 0 or 1 and are read and written 8 at a time.
+template <int Nodes> struct tBrainWidth
+{
+    enum { nodes = Nodes, nodeMask = Nodes - 1, sensorNodes = Nodes - 27, words = Nodes / 64 };
+    
+    // the widest camera whose sensors all fit in front of the actuators:
+    // 5 for 64 nodes, 9 for 128 and 15 for 256
+    static int largestCamera(void)
+    {
+        int size = 1;
+        
+        while ((size + 2) * (size + 2) <= sensorNodes)
+        {
+            size += 2;
+        }
+        
+        return size;
+    }
+    
+    struct tPacked
+    {
+        uint64_t word[words];
+        
+        bool operator==(const tPacked &other) const
+        {
+            return memcmp(word, other.word, sizeof(word)) == 0;
+        }
+    };
+    
+    static void pack(const unsigned char *states, tPacked &packed)
+    {
+        for (int w = 0; w < words; ++w)
+        {
+            packed.word[w] = 0;
+            
+            for (int i = 0; i < 64; i += 8)
+            {
+                uint64_t bytes;
+                memcpy(&bytes, states + 64 * w + i, 8);
+                packed.word[w] |= (((bytes & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56) << i;
+            }
+        }
+    }
+    
+    static void unpack(const tPacked &packed, unsigned char *states)
+    {
+        for (int w = 0; w < words; ++w)
+        {
+            for (int i = 0; i < 64; i += 8)
+            {
+                uint64_t bits = (packed.word[w] >> i) & 255;
+                uint64_t bytes = (((bits & 127) * 0x0002040810204081ULL) & 0x0101010101010101ULL) | ((bits >> 7) << 56);
+                memcpy(states + 64 * w + i, &bytes, 8);
+            }
+        }
+    }
+};
 
 #endif
\ No newline at end of file
@@ -37,318 +37,114 @@
 #include "tHMM.h"
 #include "tAgent.h"
 #include "tGame.h"
+#include "tFarm.h"
+#include "tCheckpoint.h"
+#include "tGenomeFile.h"
+#include "tDataset.h"
+#include "tConfig.h"
+#include "tEvolution.h"
+#include "tSweep.h"
+#include "tBench.h"
+#include "tMetrics.h"
+#include "tTrace.h"
 
 
-string  findBestRun(tAgent *eddAgent);
-
 using namespace std;
 
-double  perSiteMutationRate         = 0.0005;
-int     populationSize              = 100;
-int     totalGenerations            = 252;
-tGame   *game                       = NULL;
-
-bool    make_interval_video         = false;
-int     make_video_frequency        = 25;
-bool    make_LOD_video              = false;
-bool    track_best_brains           = false;
-int     track_best_brains_frequency = 25;
-bool    display_only                = false;
-bool    display_directory           = false;
-bool    make_logic_table            = false;
-bool    make_dot_edd                = false;
-int     gridSizeX                   = 5;
-int     gridSizeY                   = 5;
-bool    zoomingCamera               = false;
-bool    randomPlacement             = false;
-bool    noise                       = false;
-float   noiseAmount                 = 0.05;
-bool    tournament                  = true;
-bool    roulette                    = false;
-bool    pure_elitism                = false;
-int     roulette_size               = 2;
-bool    rank_selection              = false;
-bool    elitism                     = false;
-bool    top_percent                 = false;
-float   percent_select              = 0.10;
-int     tourney_size                = 2;
-int     elite_size                  = 1;
-
 
 int main(int argc, char *argv[])
 {
-	vector<tAgent*> eddAgents, EANextGen;
-	tAgent *eddAgent = NULL, *bestEddAgent = NULL;
-	double eddMaxFitness = 0.0;
-    string LODFileName = "", eddGenomeFileName = "", inputGenomeFileName = "";
-    string eddDotFileName = "", logicTableFileName = "", visualizationFileName = "";
-    int displayDirectoryArgvIndex = 0;
+    tConfig config;
+    tAgent *eddAgent = new tAgent;
     
-    // initial object setup
-    eddAgents.resize(populationSize);
-	eddAgent = new tAgent;
+    config.parseArguments(argc, argv, cout);
+    eddSrand(config.randomSeed);
+    eventDrivenBrains = config.event_driven;
+    brainNodes = config.brain_nodes;
+    fuseEventGates = config.fuse_gates;
     
-    // time-based seed by default. can change with command-line parameter.
-    srand((unsigned int)time(NULL));
+    if (config.trace_file != "")
+    {
+        traceStart(config.trace_file.c_str());
+        traceSetThreadName("main");
+    }
     
-    for (int i = 1; i < argc; ++i)
+    // genome given to -d, -lt or -df
+    if (config.inputGenomeFileName != "")
     {
-        // -d [in file name] [out file name]: display the given genome in a simulation
-        if (strcmp(argv[i], "-d") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            eddAgent->loadAgent(argv[i]);
-            
-            ++i;
-            stringstream vizfn;
-            vizfn << argv[i];
-            visualizationFileName = vizfn.str();
-            
-            display_only = true;
-        }
-        
-        // -dd [directory]: display all genome files in a given directory
-        if (strcmp(argv[i], "-dd") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            displayDirectoryArgvIndex = i;
-            
-            display_directory = true;
-        }
-        
-        // -e [out file name] [out file name]: evolve
-        else if (strcmp(argv[i], "-e") == 0 && (i + 2) < argc)
-        {
-            ++i;
-            stringstream lodfn;
-            lodfn << argv[i];
-            LODFileName = lodfn.str();
-            
-            ++i;
-            stringstream sgfn;
-            sgfn << argv[i];
-            eddGenomeFileName = sgfn.str();
-        }
-        
-        // -s [int]: set seed
-        else if (strcmp(argv[i], "-s") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            srand(atoi(argv[i]));
-            
-            cout << "random seed set to " << atoi(argv[i]) << endl;
-        }
-        
-        // -g [int]: set generations
-        else if (strcmp(argv[i], "-g") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            totalGenerations = atoi(argv[i]);
-            
-            if (totalGenerations < 5)
-            {
-                cerr << "minimum number of generations permitted is 5." << endl;
-                exit(0);
-            }
-            
-            cout << "generations set to " << totalGenerations << endl;
-        }
-        
-        // -t [int]: track best brains
-        else if (strcmp(argv[i], "-t") == 0 && (i + 1) < argc)
-        {
-            track_best_brains = true;
-            ++i;
-            track_best_brains_frequency = atoi(argv[i]);
-            
-            if (track_best_brains_frequency < 1)
-            {
-                cerr << "minimum brain tracking frequency is 1." << endl;
-                exit(0);
-            }
-        }
-        
-        // -v [int]: make video of best brains at an interval
-        else if (strcmp(argv[i], "-v") == 0 && (i + 1) < argc)
-        {
-            make_interval_video = true;
-            ++i;
-            make_video_frequency = atoi(argv[i]);
-            
-            if (make_video_frequency < 1)
-            {
-                cerr << "minimum video creation frequency is 1." << endl;
-                exit(0);
-            }
-        }
-        
-        // -lv: make video of LOD of best agent brain at the end
-        else if (strcmp(argv[i], "-lv") == 0)
-        {
-            make_LOD_video = true;
-        }
+        eddAgent->loadAgent((char *)config.inputGenomeFileName.c_str());
         
-        // -lt [in file name] [out file name]: create logic table for given genome
-        else if (strcmp(argv[i], "-lt") == 0 && (i + 2) < argc)
+        if (config.make_logic_table || config.make_dot_edd || config.make_logic_network)
         {
-            ++i;
-            eddAgent->loadAgent(argv[i]);
             eddAgent->setupPhenotype();
-            ++i;
-            stringstream ltfn;
-            ltfn << argv[i];
-            logicTableFileName = ltfn.str();
-            make_logic_table = true;
-        }
-        
-        // -df [in file name] [out file name]: create dot image file for given genome
-        else if (strcmp(argv[i], "-df") == 0 && (i + 2) < argc)
-        {
-            ++i;
-            eddAgent->loadAgent(argv[i]);
-            eddAgent->setupPhenotype();
-            ++i;
-            stringstream dfn;
-            dfn << argv[i];
-            eddDotFileName = dfn.str();
-            make_dot_edd = true;
-        }
-        
-        // -gs [int] [int]: set the digit grid size
-        else if (strcmp(argv[i], "-gs") == 0 && (i + 2) < argc)
-        {
-            ++i;
-            gridSizeX = atoi(argv[i]);
-            ++i;
-            gridSizeY = atoi(argv[i]);
-            
-            if (gridSizeX < 5 || gridSizeY < 5)
-            {
-                cerr << "minimum grid size dimension is 5." << endl;
-                exit(0);
-            }
-            
-            cout << "grid size set to: (" << gridSizeX << ", " << gridSizeY << ")" << endl;
-        }
-        
-        // -zc: allow the edd agent to use a zooming camera
-        else if (strcmp(argv[i], "-zc") == 0)
-        {
-            cout << "zooming camera enabled" << endl;
-            zoomingCamera = true;
-        }
-        
-        // -rp: randomly place the digits within the grid. if randomPlacement = false,
-        // the digits are always centered
-        else if (strcmp(argv[i], "-rp") == 0)
-        {
-            cout << "random placement of digits enabled" << endl;
-            randomPlacement = true;
-        }
-        
-        // -noise [float]: add noise to the edd agent's camera; each input bit is flipped
-        // with the probability given (0.0 = never, 1.0 = always flipped)
-        else if (strcmp(argv[i], "-noise") == 0 && (i + 1) < argc)
-        {
-            noise = true;
-            ++i;
-            noiseAmount = atof(argv[i]);
-            cout << "noise enabled with probability: " << noiseAmount << endl;
-        }
-        
-        // -p [int]: set the population size:
-        else if (strcmp(argv[i], "-p") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            populationSize = atoi(argv[i]);
-            eddAgents.resize(populationSize);
-            eddAgent = new tAgent;
-            
-            cout << "population size set to " << populationSize << endl;
-        }
-        
-        // -mr [float]: set the population size:
-        else if (strcmp(argv[i], "-mr") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            perSiteMutationRate = atof(argv[i]);
-            cout << "mutation rate set to " << perSiteMutationRate << endl;
-        }
-        
-        // -rl [int]: use roulette style selection:
-        else if (strcmp(argv[i], "-rl") == 0 && (i + 1) < argc)
-        {
-            i++;
-            roulette_size = atof(argv[i]);
-            roulette = true;
-            tournament = false;
-            cout << "using roulette selection mechanism (" << roulette_size << " per roulette choice)..." << endl;
-        }
-        
-        // -rs: use rank selection:
-        else if (strcmp(argv[i], "-rs") == 0 && (i + 1) < argc)
-        {
-            rank_selection = true;
-            tournament = false;
-            cout << "using rank-selection selection mechanism... " << endl;
-        }
-        
-        // -el: toggle elitism (stores the best genome in addition to the selection mechanism:
-        else if (strcmp(argv[i], "-el") == 0 && (i + 1) < argc)
-        {
-            elitism = true;
-            cout << "using elitism... " << endl;
-        }
-        
-        // -tp [float]: randomly choose an agent from the given top percent of agents:
-        else if (strcmp(argv[i], "-tp") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            percent_select
-            = atof(argv[i]);
-            top_percent = true;
-            tournament = false;
-            cout << "using top percent selection mechanism (top " << percent_select * 100 << "%)..."  << endl;
-        }
-        
-        // -tr [float]: use tournament style selection with a custom sized grouping:
-        else if (strcmp(argv[i], "-tr") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            tourney_size = atof(argv[i]);
-            cout << "using tournament style selection mechanism (" << tourney_size << " agents per selection)..."  << endl;
-        }
-        
-        // -eli [float]: use tournament style selection with a custom sized grouping:
-        else if (strcmp(argv[i], "-eli") == 0 && (i + 1) < argc)
-        {
-            ++i;
-            elite_size = atof(argv[i]);
-            tournament = false;
-            pure_elitism = true;
-            cout << "using pure elitism selection mechanism (" << elite_size << " agents per selection)..."  << endl;
         }
-        
     }
     
     // set up the simulation
-    game = new tGame;
+    tGame *game = new tGame;
+    game->totalSteps = config.totalSteps;
+    game->readyActuator = config.readyActuator;
+    game->speedBonus = config.speedBonus;
+    game->retinaPooling = config.retina_pooling;
+    game->retinaSize = config.retina_size;
+    
+    if (config.dataset_file != "" && !game->loadDataset(config.dataset_file.c_str(), config.gridSizeX, config.gridSizeY))
+    {
+        exit(0);
+    }
+    
+    if (!game->setAugmentation(config.augment_cache))
+    {
+        exit(0);
+    }
+    
+    if (config.worker_port > 0)
+    {
+        tFarm::listenForMasters(config.worker_port);
+        exit(0);
+    }
+    
+    if (config.sweep_file != "")
+    {
+        runSweep(config.sweep_file, config.sweep_directory, config.sweep_cores);
+        exit(0);
+    }
+    
+    if (config.bench_generations > 0)
+    {
+        exit(runBench(config) ? 0 : 1);
+    }
     
-    if (display_only)
+    if (config.aggregate_file != "")
     {
-        string bestString = findBestRun(eddAgent);
+        aggregateMetrics(config.aggregate_file.c_str(), config.aggregate_inputs);
+        exit(0);
+    }
+    
+    if (config.display_only)
+    {
+        string bestString = findBestRun(game, eddAgent, config);
+        
+        if (config.fuse_gates && eddAgent->eventBrain != NULL)
+        {
+            tEventBrain *fused = eddAgent->eventBrain;
+            cout << fused->sourceGates << " gates fused into " << fused->tables() << " tables ("
+                 << fused->duplicateGates << " duplicates dropped, " << fused->fusedGates << " merged into wider gates)"
+                 << endl;
+        }
+        
         ofstream visualizationFile;
-        visualizationFile.open(visualizationFileName.c_str());
+        visualizationFile.open(config.visualizationFileName.c_str());
         visualizationFile << bestString;
         visualizationFile.close();
         exit(0);
     }
     
-    if (display_directory)
+    if (config.display_directory)
     {
         DIR *dir;
         struct dirent *ent;
-        dir = opendir(argv[displayDirectoryArgvIndex]);
+        dir = opendir(config.displayDirectory.c_str());
         
         // map: run # -> [swarm file name, predator file name]
         map< int, vector<string> > fileNameMap;
@@ -386,11 +182,11 @@ int main(int argc, char *argv[])
                     // map the file name into the appropriate location
                     if (dirFile.find("swarm") != string::npos)
                     {
-                        fileNameMap[runNumber][0] = argv[displayDirectoryArgvIndex] + dirFile;
+                        fileNameMap[runNumber][0] = config.displayDirectory + dirFile;
                     }
                     else if (dirFile.find("predator") != string::npos)
                     {
-                        fileNameMap[runNumber][1] = argv[displayDirectoryArgvIndex] + dirFile;
+                        fileNameMap[runNumber][1] = config.displayDirectory + dirFile;
                     }
                 }
             }
@@ -399,7 +195,7 @@ int main(int argc, char *argv[])
         }
         else
         {
-            cerr << "invalid directory: " << argv[displayDirectoryArgvIndex] << endl;
+            cerr << "invalid directory: " << config.displayDirectory << endl;
             exit(0);
         }
         
@@ -412,7 +208,7 @@ int main(int argc, char *argv[])
                 
                 eddAgent->loadAgent((char *)it->second[0].c_str());
                 
-                string bestString = findBestRun(eddAgent);
+                string bestString = findBestRun(game, eddAgent, config);
                 
                 cout << "displaying video for run " << it->first << endl;
                 
@@ -430,541 +226,112 @@ int main(int argc, char *argv[])
         exit(0);
     }
     
-    if (make_logic_table)
+    if (config.make_logic_table)
     {
-        eddAgent->saveLogicTable(logicTableFileName.c_str());
+        if (config.logic_outputs.empty())
+        {
+            logicDefaultNodes(config.logic_inputs, config.logic_outputs);
+        }
+        
+        eddAgent->saveLogicTable(config.logicTableFileName.c_str(), config.logic_inputs, config.logic_outputs);
         exit(0);
     }
     
-    if (make_dot_edd)
+    if (config.make_logic_network)
     {
-        eddAgent->saveToDot(eddDotFileName.c_str());
+        tLogicNetwork network;
+        
+        if (!network.build(eddAgent))
+        {
+            cerr << "the brain of " << config.inputGenomeFileName << " is not deterministic" << endl;
+            exit(0);
+        }
+        
+        network.write(config.logicNetworkFileName.c_str());
+        cout << network.gates << " gates minimized to " << network.cubes.size() << " products with "
+             << network.literals() << " literals" << endl;
+        
+        tEventBrain fused;
+        fused.build(eddAgent->hmmus, true);
+        cout << fused.sourceGates << " gates fuse into " << fused.tables() << " tables (" << fused.duplicateGates
+             << " duplicates dropped, " << fused.fusedGates << " merged into wider gates)" << endl;
         exit(0);
     }
     
-    // seed the agents
-    delete eddAgent;
-    eddAgent = new tAgent;
-    eddAgent->setupRandomAgent(10000);
-    //eddAgent->loadAgent("startAgent.genome");
-    
-    // make mutated copies of the start genome to fill up the initial population
-	for(int i = 0; i < populationSize; ++i)
+    if (config.make_dot_edd)
     {
-		eddAgents[i] = new tAgent;
-		eddAgents[i]->inherit(eddAgent, 0.01, 1, false);
+        eddAgent->saveToDot(config.eddDotFileName.c_str());
+        exit(0);
     }
     
-	EANextGen.resize(populationSize);
-    
-	eddAgent->nrPointingAtMe--;
-    
-	cout << "setup complete" << endl;
-    cout << "starting evolution" << endl;
-    
-    // main loop
-	for (int update = 1; update <= totalGenerations; ++update)
+    if (config.idx_dataset_file != "")
     {
-        
-        
-        
-        
-        //cout << update << endl;
-        //cout << populationSize << endl;
-        //cout << perSiteMutationRate << endl;
-        
-        
-        
-        
-        
-        // reset fitnesses
-		for(int i = 0; i < populationSize; ++i)
-        {
-			eddAgents[i]->fitness = 0.0;
-			//eddAgents[i]->fitnesses.clear();
-		}
-        
-        // determine fitness of population
-		eddMaxFitness = 0.0;
-        double eddAvgFitness = 0.0;
-        int eddMaxIndex = 0;
-        
-		for (int i = 0; i < populationSize; ++i)
+        if (tDataset::convert(config.idx_images_file.c_str(), config.idx_labels_file.c_str(), config.idx_threshold,
+                              config.idx_dataset_file.c_str()))
         {
-            game->executeGame(eddAgents[i], NULL, false, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
-            
-            eddAvgFitness += eddAgents[i]->classificationFitness;
-            
-            //eddAgents[i]->fitnesses.push_back(eddAgents[i]->fitness);
-            
-            if(eddAgents[i]->classificationFitness > eddMaxFitness)
-            {
-                eddMaxFitness = eddAgents[i]->classificationFitness;
-                eddMaxIndex = i;
-            }
-		}
-        
-        eddAvgFitness /= (double)populationSize;
-        
-        // make a copy of the best agent
-        if (bestEddAgent != NULL)
-        {
-            delete bestEddAgent;
-        }
-        bestEddAgent = new tAgent;
-        bestEddAgent->inherit(eddAgents[eddMaxIndex], 0.0, update, false);
-        bestEddAgent->setupPhenotype();
-		
-        if (update % 1000 == 0)
-        {
-            cout << "gen " << update << ": edd [" << eddAvgFitness << " : " << eddMaxFitness << "] [genome: " << bestEddAgent->genome.size() << "] [gates: " << bestEddAgent->hmmus.size() << "]" << endl;
-        }
-        
-        // display video of simulation
-        if (make_interval_video)
-        {
-            bool finalGeneration = (update == totalGenerations);
-            
-            if (update % make_video_frequency == 0 || finalGeneration)
-            {
-                string bestString = game->executeGame(bestEddAgent, NULL, true, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
-                
-                if (finalGeneration)
-                {
-                    bestString.append("X");
-                }
-            }
-        }
-        
-        
-        
-        if (tournament == true){
-            
-            //index value for most fit tAgent in the tournament round:
-            int best_index = 0;
-            
-            /*
-            sort(eddAgents.begin(), eddAgents.end(), compare);
-            
-            for (int i = 0; i < populationSize; i++){
-                cout << eddAgents[i]->fitness << endl;
-            }
-            */
-            
-            // randomly shuffle the agents
-            random_shuffle(eddAgents.begin(), eddAgents.end());
-            
+            tDataset dataset;
             
-            
-            
-            tAgent best;
-            //best->inherit(eddAgents[0], perSiteMutationRate, update, false);
-            if (elitism == true){
-                int index = 0;
-                for (int i = 1; i < populationSize; i++){
-                    if (eddAgents[i]->fitness > eddAgents[index]->fitness){
-                        //cout << i << " : " << index << " : " << eddAgents[i]->fitness << " : " << eddAgents[index]->fitness<< endl;
-                        index = i;
-                    } else {
-                        //cout << index;
-                        //cout << "--------------" << endl;
-                    }
-                }
-                best.inherit(eddAgents[index], perSiteMutationRate, update, false);
-                //cout << eddAgents[index]->fitness << "!@#$@$%@%$#@%@#%!@#!@#4" << endl;
-            }
-        
-            for(int i = 0; i < populationSize; i += tourney_size)
-            {
-                
-                if ((populationSize - i) > tourney_size){
-                    
-                    best_index = 0;
-                    
-                    //determines the most fit agent in the current batch:
-                    for (int j = 0; j < tourney_size; j++){
-                        if (eddAgents[i + j]->fitness > eddAgents[i + best_index]->fitness){
-                            best_index = j;
-                        }
-                    }
-                    
-                    for (int j = 0; j < tourney_size; j++){
-                        tAgent *offspring = new tAgent;
-                        
-                        offspring->inherit(eddAgents[i + best_index], perSiteMutationRate, update, false);
-                        
-                        EANextGen[i + j] = offspring;
-                    }
-                     
-                } else {
-                    
-                    int tourney_remainder = populationSize - i;
-                    
-                    best_index = 0;
-                    
-                    //determines the most fit agent in the current batch:
-                    for (int j = 0; j < tourney_remainder; j++){
-                        if (eddAgents[i + j]->fitness > eddAgents[i + best_index]->fitness){
-                            best_index = j;
-                        }
-                    }
-                    
-                    for (int j = 0; j < tourney_remainder; j++){
-                        tAgent *offspring = new tAgent;
-                        
-                        offspring->inherit(eddAgents[i + best_index], perSiteMutationRate, update, false);
-                        
-                        EANextGen[i + j] = offspring;
-                    }
-                
-                
-            }
-                
-            }
-            
-            
-            
-            // shuffle the populations so there is a minimal chance of the same predator/prey combo in the next generation
-            random_shuffle(EANextGen.begin(), EANextGen.end());
-            
-            for(int i = 0; i < populationSize; ++i)
-            {
-                // replace the edd agents from the previous generation
-                eddAgents[i]->nrPointingAtMe--;
-                if(eddAgents[i]->nrPointingAtMe == 0)
-                {
-                    delete eddAgents[i];
-                }
-                eddAgents[i] = EANextGen[i];
-            }
-            
-            
-            
-            //replaces the agent with the lowest fitness with the most fit agent from last generation:
-            if (elitism == true){
-                
-                sort(eddAgents.begin(), eddAgents.end(), compare);
-                
-                *eddAgents[0] = best;
-            }
-            
-            
-            //delete best;
-            
-  
-            
-        } else if (roulette == true){
-            
-            /*
-            sort(eddAgents.begin(), eddAgents.end(), compare);
-            
-            for (int i = 0; i < populationSize; i++){
-                cout << eddAgents[i]->fitness << endl;
-            }
-             */
-            
-            float fit_count = 0.0;
-            float total_fit = 0.0;
-            bool chosen = false;
-            float random_cutoff;
-            
-            // randomly shuffle the agents
-            random_shuffle(eddAgents.begin(), eddAgents.end());
-            
-            
-            tAgent best;
-            //best->inherit(eddAgents[0], perSiteMutationRate, update, false);
-            if (elitism == true){
-                int index = 0;
-                for (int i = 1; i < populationSize; i++){
-                    if (eddAgents[i]->fitness > eddAgents[index]->fitness){
-                        //cout << i << " : " << index << " : " << eddAgents[i]->fitness << " : " << eddAgents[index]->fitness<< endl;
-                        index = i;
-                    } else {
-                        //cout << index;
-                        //cout << "--------------" << endl;
-                    }
-                }
-                best.inherit(eddAgents[index], perSiteMutationRate, update, false);
-                //cout << eddAgents[index]->fitness << "!@#$@$%@%$#@%@#%!@#!@#4" << endl;
-            }
-            
-            for(int i = 0; i < populationSize; i += roulette_size)
-            {
-                
-                if ((populationSize - (i)) > roulette_size){
-                    
-                    
-                    //creates the "roulette wheel":
-                    fit_count = 0.0;
-                    total_fit = 0.0;
-                    for (int j = 0; j < roulette_size; j++)
-                    {
-                        total_fit += eddAgents[i + j]->fitness;
-                    }
-                    
-                    random_cutoff = randDouble * total_fit;
-                    chosen = false;
-                    //determines random winner from the roulette wheel:
-                    for (int j = 0; (chosen == false) and (j < roulette_size); j++)
-                    {
-                        fit_count += eddAgents[i + j]->fitness;
-                        
-                        if (fit_count > random_cutoff){
-                            
-                            for (int p = 0; p < roulette_size; p++)
-                            {
-                                tAgent *offspring = new tAgent;
-
-                                offspring->inherit(eddAgents[i + j], perSiteMutationRate, update, false);
-                                
-                                EANextGen[i + p] = offspring;
-                                
-                            }
-                            
-                            chosen = true;
-                        }
-                    }
-                    
-                } else {
-                    
-                    int roulette_remainder = populationSize - (i);
-                    
-                    //tAgent *offspring = new tAgent;
-                    fit_count = 0.0;
-                    total_fit = 0.0;
-                    for (int j = 0; j < roulette_remainder; j++){
-                        total_fit += eddAgents[i + j]->fitness;
-                    }
-                    
-                    //uniform_real_distribution<float> dist(0, total_fit);
-                    random_cutoff = randDouble * total_fit;
-                    chosen = false;
-                    //determines random winner from the roulette wheel:
-                    for (int j = 0; (chosen == false) and (j < roulette_remainder); j++)
-                    {
-                        fit_count += eddAgents[i + j]->fitness;
-
-                        if (fit_count > random_cutoff){
-                            
-                            for (int p = 0; p < roulette_remainder; p++)
-                            {
-                                tAgent *offspring = new tAgent;
-                                
-                                offspring->inherit(eddAgents[i + j], perSiteMutationRate, update, false);
-                                
-                                EANextGen[i + p] = offspring;
-                            }
-
-                            chosen = true;
-                        }
-                    }
-                     
-                }
-            }
-
-            
-            
-            // shuffle the populations so there is a minimal chance of the same predator/prey combo in the next generation
-            random_shuffle(EANextGen.begin(), EANextGen.end());
-            
-            
-            for(int i = 0; i < populationSize; ++i)
-            {
-                // replace the edd agents from the previous generation
-                eddAgents[i]->nrPointingAtMe--;
-                if(eddAgents[i]->nrPointingAtMe == 0)
-                {
-                    delete eddAgents[i];
-                }
-                
-                
-                 
-                eddAgents[i] = EANextGen[i];
-                
-            }
-            
-            //replaces the agent with the lowest fitness with the most fit agent from last generation:
-            if (elitism == true){
-                
-                sort(eddAgents.begin(), eddAgents.end(), compare);
-                
-                *eddAgents[0] = best;
-            }
-            
-        } else if (top_percent == true){
-            
-            // randomly shuffle the agents
-            random_shuffle(eddAgents.begin(), eddAgents.end());
-            
-            tAgent best;
-            if (elitism == true){
-                int index = 0;
-                for (int i = 1; i < populationSize; i++){
-                    if (eddAgents[i]->fitness > eddAgents[index]->fitness){
-                        index = i;
-                    }
-                }
-                best.inherit(eddAgents[index], perSiteMutationRate, update, false);
-            }
-            
-            
-            // sort the agents:
-            
-            sort(eddAgents.begin(), eddAgents.end(), compare);
-            
-            //randomly select a parent from the top percentage of agents:
-            int selection = floor(populationSize * percent_select);
-            int cutoff = randDouble * selection;
-            
-            for (int k = 0; k < populationSize; k++){
-                tAgent *offspring = new tAgent;
-                offspring->inherit(eddAgents[populationSize - 1 - cutoff], perSiteMutationRate, update, false);
-                EANextGen[k] = offspring;
-            }
-            
-            
-            
-            
-            // shuffle the populations so there is a minimal chance of the same predator/prey combo in the next generation
-            random_shuffle(EANextGen.begin(), EANextGen.end());
-            
-            for(int i = 0; i < populationSize; ++i)
-            {
-                // replace the edd agents from the previous generation
-                eddAgents[i]->nrPointingAtMe--;
-                if(eddAgents[i]->nrPointingAtMe == 0)
-                {
-                    delete eddAgents[i];
-                }
-
-                eddAgents[i] = EANextGen[i];
-            }
-            
-            //replaces the agent with the lowest fitness with the most fit agent from last generation:
-            if (elitism == true){
-                
-                sort(eddAgents.begin(), eddAgents.end(), compare);
-                
-                *eddAgents[0] = best;
-            }
-            
-        } else if (pure_elitism == true){
-            
-            //for (int i = 0; i<populationSize; i++){
-            //    cout << eddAgents[i]->fitness << endl;
-            //}
-            
-            
-            // sort the agents:
-            
-            sort(eddAgents.begin(), eddAgents.end(), compare);
-            
-            
-            for (int k = 0; k < populationSize; k++){
-                tAgent *offspring = new tAgent;
-                offspring->inherit(eddAgents[populationSize - 1 - (k % elite_size)], perSiteMutationRate, update, false);
-                EANextGen[k] = offspring;
-            }
-            
-            
-            for(int i = 0; i < populationSize; ++i)
+            if (dataset.open(config.idx_dataset_file.c_str()))
             {
-                // replace the edd agents from the previous generation
-                eddAgents[i]->nrPointingAtMe--;
-                if(eddAgents[i]->nrPointingAtMe == 0)
-                {
-                    delete eddAgents[i];
-                }
-                
-                eddAgents[i] = EANextGen[i];
+                cout << "wrote " << dataset.size() << " " << dataset.width() << "x" << dataset.height() << " image(s) to "
+                     << config.idx_dataset_file << endl;
             }
-            
-            
         }
         
+        exit(0);
+    }
+    
+    if (config.binary_genome_file != "" && config.text_genome_prefix == "")
+    {
+        vector<tAgent*> agents;
+        vector<string> sources;
         
-        
-        
-        
-        
-        
-        if (track_best_brains && update % track_best_brains_frequency == 0)
+        for (int i = 0; i < config.text_genome_files.size(); ++i)
         {
-            stringstream ess;
-            
-            ess << eddGenomeFileName << "-gen" << update;
+            tAgent *agent = new tAgent;
+            agent->loadAgent((char *)config.text_genome_files[i].c_str());
+            agent->born = 0;
+            agent->fitness = 0.0;
+            agents.push_back(agent);
             
-            bestEddAgent->saveGenome(ess.str().c_str());
+            // keep the file name, without its directory, as the genome's source
+            sources.push_back(config.text_genome_files[i].substr(config.text_genome_files[i].rfind('/') + 1));
         }
-	}
-	
-    // save the genome file of the best agent
-	bestEddAgent->saveGenome(eddGenomeFileName.c_str());
-    
-    // save video and quantitative stats on the best swarm agent's LOD
-    vector<tAgent*> saveLOD;
-    
-    cout << "building ancestor list" << endl;
-    
-    // use 2 ancestors down from current population because that ancestor is highly likely to have high fitness
-    tAgent* curAncestor = bestEddAgent;
-    
-    while (curAncestor != NULL)
-    {
-        // don't add the base ancestor
-        if (curAncestor->ancestor != NULL)
+        
+        if (tGenomeCorpus::write(config.binary_genome_file.c_str(), agents, sources))
         {
-            saveLOD.insert(saveLOD.begin(), curAncestor);
+            cout << "wrote " << agents.size() << " genome(s) to " << config.binary_genome_file << endl;
         }
         
-        curAncestor = curAncestor->ancestor;
+        exit(0);
     }
     
-    FILE *LOD = fopen(LODFileName.c_str(), "w");
-
-    fprintf(LOD, "generation,fitness\n");
-    
-    cout << "analyzing ancestor list" << endl;
-    
-    for (vector<tAgent*>::iterator it = saveLOD.begin(); it != saveLOD.end(); ++it)
+    if (config.binary_genome_file != "" && config.text_genome_prefix != "")
     {
-        // collect quantitative stats
-        game->executeGame(*it, LOD, false, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
+        tGenomeCorpus corpus;
         
-        // make video
-        if (make_LOD_video)
+        if (!corpus.open(config.binary_genome_file.c_str()))
         {
-            string bestString = findBestRun(eddAgent);
+            exit(0);
+        }
+        
+        for (uint64_t i = 0; i < corpus.size(); ++i)
+        {
+            tAgent agent;
             
-            if ( (it + 1) == saveLOD.end() )
+            if (corpus.loadAgent(i, &agent))
             {
-                bestString.append("X");
+                stringstream tfn;
+                tfn << config.text_genome_prefix << "-" << i << ".genome";
+                agent.saveGenome(tfn.str().c_str());
             }
         }
+        
+        cout << "wrote " << corpus.size() << " genome(s) to " << config.text_genome_prefix << "-*.genome" << endl;
+        exit(0);
     }
     
-    fclose(LOD);
+    runEvolution(config);
     
     return 0;
 }
-
-string findBestRun(tAgent *eddAgent)
-{
-    string reportString = "", bestString = "";
-    double bestFitness = 0.0;
-    
-    for (int rep = 0; rep < 100; ++rep)
-    {
-        reportString = game->executeGame(eddAgent, NULL, true, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
-        
-        if (eddAgent->fitness > bestFitness)
-        {
-            bestString = reportString;
-            bestFitness = eddAgent->fitness;
-        }
-    }
-    
-    return bestString;
-}
-
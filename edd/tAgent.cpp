@@ -21,14 +21,34 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <map>
 #include <math.h>
+#include <string>
 #include "tAgent.h"
+#include "tGenomeFile.h"
+#include "tProfile.h"
+#include "tTrace.h"
+#include "tLogic.h"
 #include "globalConst.h"
 
+thread_local int masterID = 0;
+thread_local int brainNodes = 64;
+
+// the interpreter's step from newStates to states, with the width known when
+// compiled
+template <int Nodes> static void nextStates(unsigned char *states, unsigned char *newStates)
+{
+    memcpy(states, newStates, Nodes);
+    memset(newStates, 0, Nodes);
+}
+
 tAgent::tAgent(){
 	nrPointingAtMe=1;
 	ancestor = NULL;
+	logicNetwork = NULL;
+	eventBrain = NULL;
+    savedSteps = 0;
+    fitness = 0.0;
+    classificationFitness = 0.0;
 	for(int i=0;i<maxNodes;i++)
     {
 		states[i]=0;
@@ -42,19 +62,42 @@ tAgent::tAgent(){
 
 tAgent::~tAgent()
 {
-	for (int i = 0; i < hmmus.size(); ++i)
-    {
-        delete hmmus[i];
-    }
+    releasePhenotype();
+    
+    // a line of descent is as long as the run, so release the ancestors this
+    // agent was the last to point at one by one rather than recursively
+    tAgent *released = ancestor;
     
-	if (ancestor!=NULL)
+    while (released != NULL)
     {
-		ancestor->nrPointingAtMe--;
-		if (ancestor->nrPointingAtMe == 0)
+        released->nrPointingAtMe--;
+        
+        if (released->nrPointingAtMe != 0)
         {
-			delete ancestor;
+            break;
         }
-	}
+        
+        tAgent *next = released->ancestor;
+        released->ancestor = NULL;
+        delete released;
+        released = next;
+    }
+}
+
+// frees the gates and everything built from them; the genome stays, so
+// setupPhenotype can build them again
+void tAgent::releasePhenotype(void)
+{
+    for (int i = 0; i < hmmus.size(); ++i)
+    {
+        delete hmmus[i];
+    }
+    
+    hmmus.clear();
+    delete logicNetwork;
+    delete eventBrain;
+    logicNetwork = NULL;
+    eventBrain = NULL;
 }
 
 void tAgent::setupRandomAgent(int nucleotides)
@@ -68,14 +111,35 @@ void tAgent::setupRandomAgent(int nucleotides)
 }
 void tAgent::loadAgent(char* filename)
 {
-	FILE *f=fopen(filename,"r+t");
+    // binary genome files can hold many genomes; take the first one
+    if (tGenomeCorpus::isCorpus(filename))
+    {
+        tGenomeCorpus corpus;
+        
+        if (!corpus.open(filename) || corpus.size() == 0 || !corpus.loadAgent(0, this))
+        {
+            cerr << "could not load a genome from " << filename << endl;
+            exit(0);
+        }
+        
+        return;
+    }
+    
+	FILE *f=fopen(filename,"r");
 	int i;
+    
+    if (f == NULL)
+    {
+        cerr << "could not open genome file " << filename << endl;
+        exit(0);
+    }
+    
 	genome.clear();
-	while(!(feof(f)))
+	while (fscanf(f, "%i", &i) == 1)
     {
-		fscanf(f,"%i	",&i);
 		genome.push_back((unsigned char)(i&255));
 	}
+    fclose(f);
 	//setupPhenotype();
 }
 
@@ -83,27 +147,28 @@ void tAgent::ampUpStartCodons(void)
 {
 	int i,j;
 	for(i=0;i<genome.size();i++)
-		genome[i]=rand()&255;
+		genome[i]=eddRand()&255;
 	for(i=0;i<20;i++)
 	{
-		j=rand()%((int)genome.size()-100);
+		j=eddRand()%((int)genome.size()-100);
 		genome[j]=42;
 		genome[j+1]=(255-42);
 		for(int k=2;k<20;k++)
-			genome[j+k]=rand()&255;
+			genome[j+k]=eddRand()&255;
 	}
 }
 
 void tAgent::inherit(tAgent *from, double mutationRate, int theTime, bool evolveRetina)
 {
+    PROFILE_SCOPE(phaseInherit);
 	int nucleotides=(int)from->genome.size();
 	int i,s,o,w;
 	//double localMutationRate=4.0/from->genome.size();
 	vector<unsigned char> buffer;
 	born=theTime;
-	//ancestor=from;
-	//from->nrPointingAtMe++;
-	//from->nrOfOffspring++;
+	ancestor=from;
+	from->nrPointingAtMe++;
+	from->nrOfOffspring++;
 	genome.clear();
 	genome.resize(from->genome.size());
     
@@ -111,7 +176,7 @@ void tAgent::inherit(tAgent *from, double mutationRate, int theTime, bool evolve
     {
 		if (randDouble < mutationRate)
         {
-			genome[i]=rand()&255;
+			genome[i]=eddRand()&255;
         }
 		else
         {
@@ -124,9 +189,9 @@ void tAgent::inherit(tAgent *from, double mutationRate, int theTime, bool evolve
         if ( (randDouble < 0.05) && (genome.size() < 10000) )
         {
             //duplication
-            w=15+rand()&511;
-            s=rand()%((int)genome.size()-w);
-            o=rand()%(int)genome.size();
+            w=15+eddRand()&511;
+            s=eddRand()%((int)genome.size()-w);
+            o=eddRand()%(int)genome.size();
             buffer.clear();
             buffer.insert(buffer.begin(),genome.begin()+s,genome.begin()+s+w);
             genome.insert(genome.begin()+o,buffer.begin(),buffer.end());
@@ -134,8 +199,8 @@ void tAgent::inherit(tAgent *from, double mutationRate, int theTime, bool evolve
         if ( (randDouble < 0.02) && (genome.size() > 1000) )
         {
             //deletion
-            w=15+rand()&511;
-            s=rand()%((int)genome.size()-w);
+            w=15+eddRand()&511;
+            s=eddRand()%((int)genome.size()-w);
             genome.erase(genome.begin()+s,genome.begin()+s+w);
         }
     }
@@ -146,6 +211,8 @@ void tAgent::inherit(tAgent *from, double mutationRate, int theTime, bool evolve
 
 void tAgent::setupPhenotype(void)
 {
+    PROFILE_SCOPE(phasePhenotype);
+    TRACE_SCOPE("phenotype");
 	int i;
 	tHMMU *hmmu;
 	if(hmmus.size()!=0)
@@ -174,11 +241,57 @@ void tAgent::setupPhenotype(void)
 		}
          */
 	}
+    
+    if (eventDrivenBrains)
+    {
+        if (eventBrain == NULL)
+        {
+            eventBrain = new tEventBrain;
+        }
+        
+        if (!eventBrain->build(hmmus, fuseEventGates))
+        {
+            delete eventBrain;
+            eventBrain = NULL;
+        }
+    }
+    else
+    {
+        delete eventBrain;
+        eventBrain = NULL;
+    }
+    
+    // the compiled logic survives as long as the phenotype stays the same,
+    // e.g. over the games of one agent
+    if (logicNetwork != NULL && logicNetwork->phenotype != phenotypeHash())
+    {
+        delete logicNetwork;
+        logicNetwork = NULL;
+    }
+}
+
+// replaces the gates of a deterministic brain with their minimized logic
+// (see tLogicNetwork) for as long as the phenotype does not change.
+// stochastic brains keep their gates.
+bool tAgent::compileLogic(void)
+{
+    tLogicNetwork *network = new tLogicNetwork;
+    
+    if (!network->build(this))
+    {
+        delete network;
+        return false;
+    }
+    
+    network->phenotype = phenotypeHash();
+    delete logicNetwork;
+    logicNetwork = network;
+    return true;
 }
 
 void tAgent::resetBrain(void)
 {
-	for(int i=0;i<maxNodes;i++)
+	for(int i=0;i<brainNodes;i++)
     {
 		states[i]=0;
     }
@@ -186,21 +299,58 @@ void tAgent::resetBrain(void)
 
 void tAgent::updateStates(void)
 {
+    PROFILE_SCOPE(phaseBrain);
+    PROFILE_COUNT(counterBrainSteps, 1);
+    
+    if (logicNetwork != NULL || eventBrain != NULL)
+    {
+        if (logicNetwork != NULL)
+        {
+            tLogicNetwork::unpack(logicNetwork->update(tLogicNetwork::pack(states)), states);
+            PROFILE_COUNT(counterGateUpdates, hmmus.size());
+        }
+        else
+        {
+            int evaluated = eventBrain->update(states);
+            PROFILE_COUNT(counterGateUpdates, evaluated);
+            (void)evaluated;
+        }
+        
+        // every gate update draws a random number; draw the same ones so
+        // the game sees the same random numbers as with the gates
+        for (int i = 0; i < hmmus.size(); ++i)
+        {
+            eddRand();
+        }
+        
+        return;
+    }
+    
+    PROFILE_COUNT(counterGateUpdates, hmmus.size());
 	for(vector<tHMMU*>::iterator it = hmmus.begin(), end = hmmus.end(); it != end; ++it)
     {
 		(*it)->update(&states[0],&newStates[0]);
     }
     
-	for(int i=0;i<maxNodes;i++)
+    switch (brainNodes)
     {
-		states[i]=newStates[i];
-		newStates[i]=0;
-	}
+        case 128:
+            nextStates<128>(states, newStates);
+            break;
+            
+        case 256:
+            nextStates<256>(states, newStates);
+            break;
+            
+        default:
+            nextStates<64>(states, newStates);
+            break;
+    }
 }
 
 void tAgent::showBrain(void)
 {
-	for(int i=0;i<maxNodes;i++)
+	for(int i=0;i<brainNodes;i++)
     {
 		cout<<(int)states[i];
     }
@@ -321,98 +471,95 @@ void tAgent::saveToDot(const char *filename)
 	fclose(f);
 }
 
-void tAgent::saveLogicTable(const char *filename)
+// writes the logic table of the brain's phenotype over the given sensor and
+// actuator nodes (see tLogic.h)
+void tAgent::saveLogicTable(const char *filename, const vector<int> &inputNodes, const vector<int> &outputNodes)
+{
+    tLogicTable table;
+    extractLogicTable(this, inputNodes, outputNodes, table);
+    writeLogicTable(table, filename);
+}
+
+void tAgent::saveGenome(const char *filename)
 {
     FILE *f=fopen(filename, "w");
-	int i,j;
     
-    fprintf(f,"s0,s1,s2,s3,s4,s5,s6,s7,s8,s9,s10,s11,p15,,o1,o2\n");
-    //fprintf(f,"s11,p12,p13,p14,p15,p16,p17,p18,p19,p20,p21,p22,p23,,o1,o2\n");
+    // format the whole genome in memory and write it in one go
+    string text;
+    text.reserve(genome.size() * 4 + 1);
     
-    for(i = 0; i < (int)pow(2.0, 13.0); i++)
+	for (int i = 0, end = (int)genome.size(); i < end; ++i)
     {
-        map<vector<int>, int> outputCounts;
-        const int NUM_REPEATS = 1001;
+        int value = genome[i];
         
-        for (int repeat = 1; repeat < NUM_REPEATS; ++repeat)
+        if (value >= 100)
         {
-            for(j = 0; j < 30; j++)
-            {
-                if (j < 12)
-                {
-                    if(repeat == 1)
-                    {
-                        fprintf(f,"%i,",(i >> j) & 1);
-                    }
-                    
-                    states[j] = (i >> j) & 1;
-                }
-                else if (j == 15)
-                {
-                    if(repeat == 1)
-                    {
-                        fprintf(f,"%i,",(i >> 12) & 1);
-                    }
-                    
-                    states[j] = (i >> 12) & 1;
-                }
-                else
-                {
-                    states[j] = 0;
-                }
-            }
-            
-            updateStates();
-            
-            vector<int> output;
-            // order: 30 31
-            output.push_back(states[30]);
-            output.push_back(states[31]);
-            
-            if (outputCounts.count(output) > 0)
-            {
-                outputCounts[output]++;
-            }
-            else
-            {
-                outputCounts[output] = 1;
-            }
-            
-            // all repeats completed; determine most common output
-            if (repeat == (NUM_REPEATS - 1))
-            {
-                map<vector<int>, int>::iterator it;
-                map<vector<int>, int>::iterator mostCommonOutput = outputCounts.begin();
-                
-                for (it = outputCounts.begin(); it != outputCounts.end(); ++it)
-                {
-                    if (it->second > mostCommonOutput->second)
-                    {
-                        mostCommonOutput = it;
-                    }
-                }
-                
-                fprintf(f, ",%i,%i\n", mostCommonOutput->first[0], mostCommonOutput->first[1]);
-            }
+            text.push_back('0' + value / 100);
         }
-	}
+        if (value >= 10)
+        {
+            text.push_back('0' + (value / 10) % 10);
+        }
+        text.push_back('0' + value % 10);
+        text.push_back('\t');
+    }
+    
+	text.push_back('\n');
+    fwrite(text.data(), 1, text.size(), f);
     
     fclose(f);
 }
 
-void tAgent::saveGenome(const char *filename)
+// number of gates setupPhenotype() would build, without building them
+int tAgent::gateCount(void)
 {
-    FILE *f=fopen(filename, "w");
+    int gates = 0;
     
-	for (int i = 0, end = (int)genome.size(); i < end; ++i)
+    for (int i = 0; i < genome.size(); ++i)
     {
-		fprintf(f, "%i	", genome[i]);
+        if ((genome[i] == 42) && (genome[(i + 1) % genome.size()] == (255 - 42)))
+        {
+            ++gates;
+        }
     }
     
-	fprintf(f, "\n");
+    return gates;
+}
+
+// FNV-1a hash of the decoded gates; agents whose genomes only differ in
+// non-coding sites get the same hash. setupPhenotype() must be called first.
+unsigned long long tAgent::phenotypeHash(void)
+{
+    unsigned long long hash = 14695981039346656037ULL;
     
-    fclose(f);
+    for (int i = 0; i < hmmus.size(); ++i)
+    {
+        tHMMU *gate = hmmus[i];
+        
+        hash = (hash ^ gate->ins.size()) * 1099511628211ULL;
+        for (int j = 0; j < gate->ins.size(); ++j)
+        {
+            hash = (hash ^ gate->ins[j]) * 1099511628211ULL;
+        }
+        
+        hash = (hash ^ gate->outs.size()) * 1099511628211ULL;
+        for (int j = 0; j < gate->outs.size(); ++j)
+        {
+            hash = (hash ^ gate->outs[j]) * 1099511628211ULL;
+        }
+        
+        for (int row = 0; row < gate->hmm.size(); ++row)
+        {
+            for (int col = 0; col < gate->hmm[row].size(); ++col)
+            {
+                hash = (hash ^ gate->hmm[row][col]) * 1099511628211ULL;
+            }
+        }
+    }
+    
+    return hash;
 }
+
 /*
 bool tAgent::operator<(const tAgent& agent) const {
     return (fitness < agent.fitness);
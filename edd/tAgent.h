@@ -24,11 +24,13 @@
 
 #include "globalConst.h"
 #include "tHMM.h"
+#include "tLogic.h"
+#include "tEventBrain.h"
 #include <vector>
 
 using namespace std;
 
-static int masterID = 0;
+extern thread_local int masterID;
 
 class tDot{
 public:
@@ -39,12 +41,17 @@ public:
 class tAgent{
 public:
 	vector<tHMMU*> hmmus;
+	tLogicNetwork *logicNetwork;
+	tEventBrain *eventBrain;
 	vector<unsigned char> genome;
 	
 	tAgent *ancestor;
 	unsigned int nrPointingAtMe;
 	unsigned char states[maxNodes], newStates[maxNodes];
 	double fitness, classificationFitness;
+    
+    // steps the ready actuator saved over the last game's 10 digits
+    int savedSteps;
 	vector<double> fitnesses;
     
     // correct/incorrect guesses for each digit
@@ -60,6 +67,8 @@ public:
 	void setupRandomAgent(int nucleotides);
 	void loadAgent(char* filename);
 	void setupPhenotype(void);
+	void releasePhenotype(void);
+	bool compileLogic(void);
 	void inherit(tAgent *from,double mutationRate,int theTime, bool evolveRetina);
 	void updateStates(void);
 	void resetBrain(void);
@@ -68,8 +77,10 @@ public:
 	void showPhenotype(void);
 	void saveToDot(const char *filename);
 	void initialize(int x, int y, int d);
-	void saveLogicTable(const char *filename);
+	void saveLogicTable(const char *filename, const vector<int> &inputNodes, const vector<int> &outputNodes);
 	void saveGenome(const char *filename);
+	unsigned long long phenotypeHash(void);
+	int gateCount(void);
     //bool operator<(const tAgent& agent) const;
 };
 
@@ -0,0 +1,135 @@
+/*
+ * tAugment.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tAugment.h"
+#include "tRandom.h"
+
+tAugmentation augmentation(int variant)
+{
+    tAugmentation result;
+    result.shiftX = variant % 3 - 1;
+    result.shiftY = (variant / 3) % 3 - 1;
+    result.stroke = (variant / 9) % 3 - 1;
+    result.noise = variant / 27;
+    return result;
+}
+
+// the pixels a noise pattern drops (one in 8) or adds (one in 64) in a row,
+// as bit x for column x. the same for every digit.
+uint64_t augmentNoise(int noise, int row, bool added)
+{
+    if (noise == 0)
+    {
+        return 0;
+    }
+
+    uint64_t key = ((uint64_t)noise << 40) ^ ((uint64_t)row << 8) ^ (added ? 0x80 : 0);
+    uint64_t mask = ~0ULL;
+
+    for (int word = 0; word < (added ? 6 : 3); ++word)
+    {
+        mask &= eddMixBits(key + word);
+    }
+
+    return mask;
+}
+
+// renders a variant of a digit given as height rows, the top one first, each
+// with column x as bit x. each step works on whole rows at once: the strokes
+// are thickened (every pixel next to one that is on turns on) or thinned (the
+// right end of every horizontal run and the bottom end of every vertical run
+// longer than a pixel turn off), then the digit shifts inside its box, losing
+// what leaves it, and the noise pattern drops and adds pixels.
+void augmentRows(const uint64_t *rows, int width, int height, int variant, uint64_t *augmented)
+{
+    tAugmentation a = augmentation(variant);
+    uint64_t mask = (width >= 64) ? ~0ULL : (1ULL << width) - 1;
+
+    for (int y = 0; y < height; ++y)
+    {
+        uint64_t row = rows[y];
+        uint64_t above = (y > 0) ? rows[y - 1] : 0;
+        uint64_t below = (y + 1 < height) ? rows[y + 1] : 0;
+
+        if (a.stroke > 0)
+        {
+            row |= (row << 1) | (row >> 1) | above | below;
+        }
+        else if (a.stroke < 0)
+        {
+            row &= ~((row << 1) & ~(row >> 1)) & ~(above & ~below);
+        }
+
+        augmented[y] = row & mask;
+    }
+
+    // rows move down for a positive shiftY, so walk against the shift to
+    // read every row before it is overwritten
+    for (int i = 0; i < height; ++i)
+    {
+        int y = (a.shiftY > 0) ? height - 1 - i : i;
+        int from = y - a.shiftY;
+        uint64_t row = (from >= 0 && from < height) ? augmented[from] : 0;
+
+        if (a.shiftX > 0)
+        {
+            row <<= a.shiftX;
+        }
+        else if (a.shiftX < 0)
+        {
+            row >>= -a.shiftX;
+        }
+
+        augmented[y] = row & mask;
+    }
+
+    for (int y = 0; y < height && a.noise != 0; ++y)
+    {
+        augmented[y] = ((augmented[y] & ~augmentNoise(a.noise, y, false)) | augmentNoise(a.noise, y, true)) & mask;
+    }
+}
+
+tVariantCache::tVariantCache()
+{
+    hits = 0;
+    misses = 0;
+    variantRows = 0;
+}
+
+// empties the cache, making room for capacity variants
+void tVariantCache::reset(int capacity, int rowsPerVariant)
+{
+    variantRows = rowsPerVariant;
+    keys.assign(capacity, 0);
+    rows.assign((size_t)capacity * rowsPerVariant, 0);
+}
+
+uint64_t *tVariantCache::insert(uint64_t key)
+{
+    size_t slot = slotOf(key);
+    keys[slot] = key + 1;
+    return &rows[slot * variantRows];
+}
+
+size_t tVariantCache::slotOf(uint64_t key) const
+{
+    return eddMixBits(key) % keys.size();
+}
@@ -0,0 +1,88 @@
+/*
+ * tAugment.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tAugment_h_included_
+#define _tAugment_h_included_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+using namespace std;
+
+// every variant of a digit: a shift of -1, 0 or 1 in x and in y, thinner,
+// unchanged or thicker strokes, and one of the noise patterns of dropped and
+// added pixels, the first of which changes nothing
+#define     augmentNoisePatterns    8
+#define     augmentVariants         (3 * 3 * 3 * augmentNoisePatterns)
+#define     unchangedVariant        13
+
+// a row of a digit is one word, so digits are at most this wide
+#define     maxAugmentWidth         64
+
+struct tAugmentation
+{
+    int shiftX, shiftY, stroke, noise;
+};
+
+tAugmentation augmentation(int variant);
+uint64_t augmentNoise(int noise, int row, bool added);
+void augmentRows(const uint64_t *rows, int width, int height, int variant, uint64_t *augmented);
+
+// a bounded cache of rendered variants, each of a fixed number of rows,
+// keyed by what was rendered and how. direct-mapped: a variant evicts the
+// one that was in its slot.
+class tVariantCache
+{
+public:
+    unsigned long long hits, misses;
+
+    tVariantCache();
+    void reset(int capacity, int rowsPerVariant);
+    int capacity(void) const { return (int)keys.size(); }
+    int rowsPerVariant(void) const { return variantRows; }
+
+    // the rows cached for key, or NULL
+    const uint64_t *find(uint64_t key)
+    {
+        size_t slot = slotOf(key);
+
+        if (keys[slot] == key + 1)
+        {
+            ++hits;
+            return &rows[slot * variantRows];
+        }
+
+        ++misses;
+        return NULL;
+    }
+
+    // the rows to render key's variant into
+    uint64_t *insert(uint64_t key);
+
+private:
+    int variantRows;
+    vector<uint64_t> keys, rows;
+
+    size_t slotOf(uint64_t key) const;
+};
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * tBench.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tBench.h"
+#include "tEvolution.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <map>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+// baseline files hold one "name value" pair per line: the workload (seed,
+// population size, generations, farm), the throughputs and the fingerprint
+static bool readBaseline(const string &fileName, map<string, string> &values)
+{
+    ifstream file(fileName.c_str());
+    
+    if (!file.is_open())
+    {
+        cerr << "could not open baseline file " << fileName << endl;
+        return false;
+    }
+    
+    string line;
+    
+    while (getline(file, line))
+    {
+        stringstream words(line);
+        string name, value;
+        
+        if (words >> name >> value && name[0] != '#')
+        {
+            values[name] = value;
+        }
+    }
+    
+    return true;
+}
+
+static string hexString(unsigned long long value)
+{
+    stringstream hex;
+    hex << std::hex << setw(16) << setfill('0') << value;
+    return hex.str();
+}
+
+bool runBench(tConfig &config)
+{
+    // the same seed every time, unless one is given
+    if (!config.random_seed_set)
+    {
+        config.randomSeed = 1;
+    }
+    
+    config.totalGenerations = config.bench_generations;
+    
+    // progress messages would only get in the way of the report
+    stringstream progress;
+    config.out = &progress;
+    
+    bool farm = (config.farm_local_workers > 0 || config.farm_addresses != "");
+    tRunSummary summary = runEvolution(config);
+    
+    if (!summary.completed)
+    {
+        cerr << "the benchmark run did not complete." << endl;
+        return false;
+    }
+    
+    double generationsPerSecond = summary.generations / summary.seconds;
+    double evaluationsPerSecond = summary.evaluations / summary.seconds;
+    double brainStepsPerSecond = farm ? 0.0 : summary.brainSteps / summary.seconds;
+    string fingerprint = hexString(summary.fingerprint);
+    
+    cout << "bench: " << summary.generations << " generations of " << config.populationSize << " agents, seed " << config.randomSeed << endl;
+    cout << "seconds: " << summary.seconds << endl;
+    cout << "generations/sec: " << generationsPerSecond << endl;
+    cout << "evaluations/sec: " << evaluationsPerSecond << endl;
+    
+    if (farm)
+    {
+        cout << "brain steps/sec: not counted on the farm" << endl;
+    }
+    else
+    {
+        cout << "brain steps/sec: " << brainStepsPerSecond << endl;
+    }
+    
+    cout << "fingerprint: " << fingerprint << endl;
+    
+    if (config.bench_save_file != "")
+    {
+        ofstream baseline(config.bench_save_file.c_str());
+        
+        if (!baseline.is_open())
+        {
+            cerr << "could not write baseline file " << config.bench_save_file << endl;
+            return false;
+        }
+        
+        baseline << "# edd -bench baseline" << endl;
+        baseline << "seed " << config.randomSeed << endl;
+        baseline << "population_size " << config.populationSize << endl;
+        baseline << "generations " << summary.generations << endl;
+        baseline << "farm " << (farm ? 1 : 0) << endl;
+        baseline << setprecision(10);
+        baseline << "generations_per_second " << generationsPerSecond << endl;
+        baseline << "evaluations_per_second " << evaluationsPerSecond << endl;
+        baseline << "brain_steps_per_second " << brainStepsPerSecond << endl;
+        baseline << "fingerprint " << fingerprint << endl;
+        
+        cout << "saved baseline to " << config.bench_save_file << endl;
+    }
+    
+    if (config.bench_baseline_file == "")
+    {
+        return true;
+    }
+    
+    map<string, string> baseline;
+    
+    if (!readBaseline(config.bench_baseline_file, baseline))
+    {
+        return false;
+    }
+    
+    bool passed = true;
+    
+    // the fingerprint can only be compared for the same workload. farm workers
+    // draw their own random numbers, so farm runs evolve differently
+    stringstream workload;
+    workload << config.randomSeed << " " << config.populationSize << " " << summary.generations << " " << (farm ? 1 : 0);
+    
+    if (baseline["seed"] + " " + baseline["population_size"] + " " + baseline["generations"] + " " + baseline["farm"] != workload.str())
+    {
+        cout << "baseline ran a different workload (seed, population size, generations or farm); not comparing fingerprints" << endl;
+    }
+    else if (baseline["fingerprint"] != fingerprint)
+    {
+        cout << "FINGERPRINT CHANGED: " << fingerprint << " (baseline " << baseline["fingerprint"] << "); the results are different" << endl;
+        passed = false;
+    }
+    else
+    {
+        cout << "fingerprint matches the baseline" << endl;
+    }
+    
+    const char *names[3] = { "generations_per_second", "evaluations_per_second", "brain_steps_per_second" };
+    double rates[3] = { generationsPerSecond, evaluationsPerSecond, brainStepsPerSecond };
+    
+    for (int i = 0; i < 3; ++i)
+    {
+        double before = atof(baseline[names[i]].c_str());
+        
+        if (before <= 0.0 || rates[i] <= 0.0)
+        {
+            continue;
+        }
+        
+        double change = rates[i] / before - 1.0;
+        bool regressed = (change < -config.bench_threshold);
+        
+        cout << names[i] << ": " << rates[i] << " vs " << before << " (" << showpos << fixed << setprecision(1) << change * 100.0 << "%)"
+             << noshowpos << defaultfloat << setprecision(6) << (regressed ? " REGRESSION" : "") << endl;
+        
+        if (regressed)
+        {
+            passed = false;
+        }
+    }
+    
+    return passed;
+}
@@ -0,0 +1,34 @@
+/*
+ * tBench.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tBench_h_included_
+#define _tBench_h_included_
+
+#include "tConfig.h"
+
+using namespace std;
+
+// evolves for config.bench_generations generations with a fixed seed, prints
+// the run's throughput and fingerprint and compares them with a saved
+// baseline. returns false if the throughput regressed or the results changed.
+bool runBench(tConfig &config);
+
+#endif
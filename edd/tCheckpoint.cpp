@@ -0,0 +1,335 @@
+/*
+ * tCheckpoint.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tCheckpoint.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <map>
+#include <iostream>
+
+static const char checkpointMagic[8] = { 'E', 'D', 'D', 'C', 'H', 'K', 'P', 'T' };
+
+static uint64_t hashBytes(uint64_t hash, const void *data, size_t length)
+{
+    const unsigned char *bytes = (const unsigned char *)data;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+tCheckpoint::tCheckpoint()
+{
+    writer = 0;
+}
+
+tCheckpoint::~tCheckpoint()
+{
+    finish();
+}
+
+bool tCheckpoint::writerRunning(void)
+{
+    if (writer <= 0)
+    {
+        return false;
+    }
+
+    int status = 0;
+
+    if (waitpid(writer, &status, WNOHANG) == 0)
+    {
+        return true;
+    }
+
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+    {
+        cerr << "writing checkpoint " << fileName << " failed" << endl;
+    }
+
+    writer = 0;
+
+    return false;
+}
+
+// waits for an outstanding checkpoint to hit the disk
+void tCheckpoint::finish(void)
+{
+    if (writer > 0)
+    {
+        int status = 0;
+        waitpid(writer, &status, 0);
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            cerr << "writing checkpoint " << fileName << " failed" << endl;
+        }
+
+        writer = 0;
+    }
+}
+
+// the population is written by a forked child, which sees a copy-on-write
+// snapshot of the population, so evolution carries on while it is written.
+// returns false if the previous checkpoint is still being written.
+bool tCheckpoint::saveInBackground(vector<tAgent*> &population, tAgent *fullSetBest, int generation)
+{
+    if (writerRunning())
+    {
+        cerr << "previous checkpoint still being written; skipping generation " << generation << endl;
+        return false;
+    }
+
+    cout.flush();
+    fflush(stdout);
+
+    pid_t pid = fork();
+
+    if (pid < 0)
+    {
+        perror("fork");
+        return write(population, fullSetBest, generation);
+    }
+
+    if (pid == 0)
+    {
+        _exit(write(population, fullSetBest, generation) ? 0 : 1);
+    }
+
+    writer = pid;
+
+    return true;
+}
+
+// writes the checkpoint to a temporary file and renames it over the old one,
+// so there is always a complete checkpoint on disk
+bool tCheckpoint::write(vector<tAgent*> &population, tAgent *fullSetBest, int generation)
+{
+    // the population first, then the full-set best, then every ancestor
+    // still referenced by them
+    vector<tAgent*> agents(population.begin(), population.end());
+    map<tAgent*, int> index;
+
+    if (fullSetBest != NULL)
+    {
+        agents.push_back(fullSetBest);
+    }
+
+    for (int i = 0; i < agents.size(); ++i)
+    {
+        index[agents[i]] = i;
+    }
+
+    for (int i = 0; i < agents.size(); ++i)
+    {
+        tAgent *ancestor = agents[i]->ancestor;
+
+        if (ancestor != NULL && index.count(ancestor) == 0)
+        {
+            index[ancestor] = (int)agents.size();
+            agents.push_back(ancestor);
+        }
+    }
+
+    vector<tCheckpointAgent> records(agents.size());
+    uint64_t genomeBytes = 0;
+
+    for (int i = 0; i < agents.size(); ++i)
+    {
+        records[i].ID = agents[i]->ID;
+        records[i].born = agents[i]->born;
+        records[i].nrOfOffspring = agents[i]->nrOfOffspring;
+        records[i].ancestor = (agents[i]->ancestor == NULL) ? -1 : index[agents[i]->ancestor];
+        records[i].fitness = agents[i]->fitness;
+        records[i].classificationFitness = agents[i]->classificationFitness;
+        records[i].genomeOffset = genomeBytes;
+        records[i].genomeLength = agents[i]->genome.size();
+        genomeBytes += agents[i]->genome.size();
+    }
+
+    tCheckpointHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, checkpointMagic, sizeof(checkpointMagic));
+    header.version = checkpointVersion;
+    header.headerSize = sizeof(header);
+    header.generation = generation;
+    header.populationSize = (int32_t)population.size();
+    header.masterID = masterID;
+    header.fullSetBest = (fullSetBest == NULL) ? -1 : (int32_t)population.size();
+    eddGetRandomState(header.random);
+    header.agentCount = records.size();
+    header.genomeBytes = genomeBytes;
+
+    string temporaryName = fileName + ".tmp";
+    FILE *f = fopen(temporaryName.c_str(), "wb");
+
+    if (f == NULL)
+    {
+        perror(temporaryName.c_str());
+        return false;
+    }
+
+    setvbuf(f, NULL, _IOFBF, 1 << 22);
+
+    uint64_t checksum = 14695981039346656037ULL;
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+
+    if (records.size() > 0)
+    {
+        ok = ok && fwrite(&records[0], sizeof(tCheckpointAgent), records.size(), f) == records.size();
+        checksum = hashBytes(checksum, &records[0], records.size() * sizeof(tCheckpointAgent));
+    }
+
+    for (int i = 0; i < agents.size() && ok; ++i)
+    {
+        vector<unsigned char> &genome = agents[i]->genome;
+
+        if (genome.size() > 0)
+        {
+            ok = fwrite(&genome[0], 1, genome.size(), f) == genome.size();
+            checksum = hashBytes(checksum, &genome[0], genome.size());
+        }
+    }
+
+    // now that the body is out, fill in its checksum
+    header.checksum = checksum;
+    ok = ok && fflush(f) == 0 && fseek(f, 0, SEEK_SET) == 0 &&
+         fwrite(&header, sizeof(header), 1, f) == 1 && fflush(f) == 0 && fsync(fileno(f)) == 0;
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok || rename(temporaryName.c_str(), fileName.c_str()) != 0)
+    {
+        perror(fileName.c_str());
+        unlink(temporaryName.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+// maps a checkpoint and rebuilds the population, lineage, ID counter and
+// random number generator, so the run continues exactly where it left off.
+// generation is the last generation completed before the checkpoint.
+bool tCheckpoint::load(vector<tAgent*> &population, tAgent *&fullSetBest, int &generation)
+{
+    int fd = open(fileName.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        perror(fileName.c_str());
+        return false;
+    }
+
+    struct stat info;
+    void *mapped = MAP_FAILED;
+
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(tCheckpointHeader))
+    {
+        mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        cerr << "could not map checkpoint " << fileName << endl;
+        return false;
+    }
+
+    const unsigned char *base = (const unsigned char *)mapped;
+    tCheckpointHeader header;
+    memcpy(&header, base, sizeof(header));
+
+    uint64_t recordBytes = header.agentCount * sizeof(tCheckpointAgent);
+    bool valid = memcmp(header.magic, checkpointMagic, sizeof(checkpointMagic)) == 0 &&
+                 header.version == checkpointVersion && header.headerSize == sizeof(header) &&
+                 header.populationSize > 0 && header.populationSize <= header.agentCount &&
+                 (header.fullSetBest == -1 || (header.fullSetBest == header.populationSize && (uint64_t)header.fullSetBest < header.agentCount)) &&
+                 sizeof(header) + recordBytes + header.genomeBytes == (uint64_t)info.st_size;
+
+    const tCheckpointAgent *records = (const tCheckpointAgent *)(base + sizeof(header));
+    const unsigned char *genomes = base + sizeof(header) + recordBytes;
+
+    if (valid && hashBytes(14695981039346656037ULL, records, recordBytes + header.genomeBytes) != header.checksum)
+    {
+        cerr << "checkpoint " << fileName << " is corrupt (checksum mismatch)" << endl;
+        munmap(mapped, info.st_size);
+        return false;
+    }
+
+    for (uint64_t i = 0; valid && i < header.agentCount; ++i)
+    {
+        valid = records[i].genomeOffset + records[i].genomeLength <= header.genomeBytes &&
+                records[i].ancestor < (int64_t)header.agentCount;
+    }
+
+    if (!valid)
+    {
+        cerr << "invalid checkpoint file: " << fileName << endl;
+        munmap(mapped, info.st_size);
+        return false;
+    }
+
+    vector<tAgent*> agents(header.agentCount);
+
+    for (uint64_t i = 0; i < header.agentCount; ++i)
+    {
+        tAgent *agent = new tAgent;
+        agent->genome.assign(genomes + records[i].genomeOffset, genomes + records[i].genomeOffset + records[i].genomeLength);
+        agent->ID = records[i].ID;
+        agent->born = records[i].born;
+        agent->nrOfOffspring = records[i].nrOfOffspring;
+        agent->fitness = records[i].fitness;
+        agent->classificationFitness = records[i].classificationFitness;
+
+        // the population vector holds one reference to each of its members
+        agent->nrPointingAtMe = (i < header.populationSize) ? 1 : 0;
+        agents[i] = agent;
+    }
+
+    for (uint64_t i = 0; i < header.agentCount; ++i)
+    {
+        if (records[i].ancestor >= 0)
+        {
+            agents[i]->ancestor = agents[records[i].ancestor];
+            agents[i]->ancestor->nrPointingAtMe++;
+        }
+    }
+
+    population.assign(agents.begin(), agents.begin() + header.populationSize);
+    fullSetBest = (header.fullSetBest < 0) ? NULL : agents[header.fullSetBest];
+    generation = header.generation;
+    masterID = header.masterID;
+    eddSetRandomState(header.random);
+
+    munmap(mapped, info.st_size);
+
+    return true;
+}
@@ -0,0 +1,74 @@
+/*
+ * tCheckpoint.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tCheckpoint_h_included_
+#define _tCheckpoint_h_included_
+
+#include "globalConst.h"
+#include "tAgent.h"
+#include <sys/types.h>
+#include <stdint.h>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+#define     checkpointVersion   2
+
+// fixed-size header at the start of a checkpoint file; fullSetBest is the
+// record of the best elite scored on the full dataset, or -1
+struct tCheckpointHeader
+{
+    char magic[8];
+    uint32_t version, headerSize;
+    int32_t generation, populationSize, masterID, fullSetBest;
+    tRandomState random;
+    uint64_t agentCount, genomeBytes, checksum;
+};
+
+// one agent; the first populationSize records are the population in order,
+// then the full-set best if there is one, the rest are ancestors kept alive
+// by the lineage
+struct tCheckpointAgent
+{
+    int32_t ID, born, nrOfOffspring, ancestor;
+    double fitness, classificationFitness;
+    uint64_t genomeOffset, genomeLength;
+};
+
+class tCheckpoint
+{
+public:
+    string fileName;
+    pid_t writer;
+
+    tCheckpoint();
+    ~tCheckpoint();
+    bool saveInBackground(vector<tAgent*> &population, tAgent *fullSetBest, int generation);
+    bool load(vector<tAgent*> &population, tAgent *&fullSetBest, int &generation);
+    void finish(void);
+
+private:
+    bool writerRunning(void);
+    bool write(vector<tAgent*> &population, tAgent *fullSetBest, int generation);
+};
+
+#endif
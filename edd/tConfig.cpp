@@ -0,0 +1,851 @@
+/*
+ * tConfig.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tConfig.h"
+#include "tLogic.h"
+#include "tGame.h"
+#include "tFarm.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sstream>
+
+tConfig::tConfig()
+{
+    perSiteMutationRate         = 0.0005;
+    populationSize              = 100;
+    totalGenerations            = 252;
+    
+    // time-based seed by default. can change with command-line parameter.
+    randomSeed                  = (unsigned int)time(NULL);
+    random_seed_set             = false;
+    
+    make_interval_video         = false;
+    make_video_frequency        = 25;
+    make_LOD_video              = false;
+    lod_replicates              = 1;
+    track_best_brains           = false;
+    track_best_brains_frequency = 25;
+    display_only                = false;
+    display_directory           = false;
+    make_logic_table            = false;
+    make_dot_edd                = false;
+    make_logic_network          = false;
+    compile_logic               = false;
+    event_driven                = false;
+    fuse_gates                  = false;
+    gridSizeX                   = 5;
+    gridSizeY                   = 5;
+    zoomingCamera               = false;
+    randomPlacement             = false;
+    noise                       = false;
+    noiseAmount                 = 0.05;
+    totalSteps                  = 20;
+    readyActuator               = false;
+    speedBonus                  = 0.0;
+    brain_nodes                 = 64;
+    idx_threshold               = 128;
+    batch_per_digit             = 0;
+    full_set_frequency          = 100;
+    full_set_elites             = 5;
+    augment_cache               = 0;
+    retina_pooling              = poolNone;
+    retina_size                 = 3;
+    tournament                  = true;
+    roulette                    = false;
+    pure_elitism                = false;
+    roulette_size               = 2;
+    rank_selection              = false;
+    elitism                     = false;
+    top_percent                 = false;
+    percent_select              = 0.10;
+    tourney_size                = 2;
+    elite_size                  = 1;
+    farm_local_workers          = 0;
+    farm_batch_size             = 8;
+    farm_timeout                = farmBatchTimeout;
+    worker_port                 = 0;
+    checkpoint_frequency        = 0;
+    profile                     = false;
+    profile_interval            = 0;
+    profile_hardware            = false;
+    bench_generations           = 0;
+    bench_threshold             = 0.05;
+    sweep_cores                 = 1;
+    out                         = &cout;
+}
+
+// reads the command-line parameters into this configuration. progress messages
+// go to messages; invalid values are fatal.
+void tConfig::parseArguments(int argc, char *argv[], ostream &messages)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        // -d [in file name] [out file name]: display the given genome in a simulation
+        if (strcmp(argv[i], "-d") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            inputGenomeFileName = argv[i];
+            
+            ++i;
+            stringstream vizfn;
+            vizfn << argv[i];
+            visualizationFileName = vizfn.str();
+            
+            display_only = true;
+        }
+        
+        // -dd [directory]: display all genome files in a given directory
+        if (strcmp(argv[i], "-dd") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            displayDirectory = argv[i];
+            
+            display_directory = true;
+        }
+        
+        // -e [out file name] [out file name]: evolve
+        else if (strcmp(argv[i], "-e") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            stringstream lodfn;
+            lodfn << argv[i];
+            LODFileName = lodfn.str();
+            
+            ++i;
+            stringstream sgfn;
+            sgfn << argv[i];
+            eddGenomeFileName = sgfn.str();
+        }
+        
+        // -s [int]: set seed
+        else if (strcmp(argv[i], "-s") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            randomSeed = atoi(argv[i]);
+            random_seed_set = true;
+            
+            messages << "random seed set to " << atoi(argv[i]) << endl;
+        }
+        
+        // -g [int]: set generations
+        else if (strcmp(argv[i], "-g") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            totalGenerations = atoi(argv[i]);
+            
+            if (totalGenerations < 5)
+            {
+                cerr << "minimum number of generations permitted is 5." << endl;
+                exit(0);
+            }
+            
+            messages << "generations set to " << totalGenerations << endl;
+        }
+        
+        // -t [int]: track best brains
+        else if (strcmp(argv[i], "-t") == 0 && (i + 1) < argc)
+        {
+            track_best_brains = true;
+            ++i;
+            track_best_brains_frequency = atoi(argv[i]);
+            
+            if (track_best_brains_frequency < 1)
+            {
+                cerr << "minimum brain tracking frequency is 1." << endl;
+                exit(0);
+            }
+        }
+        
+        // -v [int]: make video of best brains at an interval
+        else if (strcmp(argv[i], "-v") == 0 && (i + 1) < argc)
+        {
+            make_interval_video = true;
+            ++i;
+            make_video_frequency = atoi(argv[i]);
+            
+            if (make_video_frequency < 1)
+            {
+                cerr << "minimum video creation frequency is 1." << endl;
+                exit(0);
+            }
+        }
+        
+        // -lv: make video of LOD of best agent brain at the end
+        else if (strcmp(argv[i], "-lv") == 0)
+        {
+            make_LOD_video = true;
+        }
+        
+        // -lodreps [int]: average the fitness of every distinct phenotype on the line of descent
+        // over [int] games
+        else if (strcmp(argv[i], "-lodreps") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            lod_replicates = atoi(argv[i]);
+            
+            if (lod_replicates < 1)
+            {
+                cerr << "minimum number of line of descent replicates is 1." << endl;
+                exit(0);
+            }
+        }
+        
+        // -lt [in file name] [out file name]: create logic table for given genome
+        else if (strcmp(argv[i], "-lt") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            inputGenomeFileName = argv[i];
+            ++i;
+            stringstream ltfn;
+            ltfn << argv[i];
+            logicTableFileName = ltfn.str();
+            make_logic_table = true;
+        }
+        
+        // -ltnodes [input nodes] [output nodes]: nodes tabulated by -lt, as comma-separated
+        // nodes and ranges (default: the 3x3 retina 0-8 and the 26 actuators)
+        else if (strcmp(argv[i], "-ltnodes") == 0 && (i + 2) < argc)
+        {
+            if (!parseLogicNodes(argv[i + 1], logic_inputs) || !parseLogicNodes(argv[i + 2], logic_outputs))
+            {
+                cerr << "invalid logic table nodes: " << argv[i + 1] << " " << argv[i + 2] << endl;
+                exit(0);
+            }
+            
+            if (logic_inputs.size() > maxLogicInputs || logic_outputs.size() > maxLogicOutputs)
+            {
+                cerr << "logic tables have at most " << maxLogicInputs << " inputs and " << maxLogicOutputs
+                     << " outputs." << endl;
+                exit(0);
+            }
+            
+            i += 2;
+        }
+        
+        // -lm [in file name] [out file name]: write the minimized logic of the given genome's brain
+        else if (strcmp(argv[i], "-lm") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            inputGenomeFileName = argv[i];
+            ++i;
+            logicNetworkFileName = argv[i];
+            make_logic_network = true;
+        }
+        
+        // -compile: play -d, -dd and the LOD analysis with brains compiled to minimized logic
+        else if (strcmp(argv[i], "-compile") == 0)
+        {
+            compile_logic = true;
+        }
+        
+        // -native [cache directory]: like -compile, and also compile the logic to native code,
+        // cached in the given directory
+        else if (strcmp(argv[i], "-native") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            native_directory = argv[i];
+            compile_logic = true;
+        }
+        
+        // -events: update deterministic brains event-driven, re-evaluating only the gates whose
+        // inputs changed since the last step
+        else if (strcmp(argv[i], "-events") == 0)
+        {
+            event_driven = true;
+        }
+        
+        // -fuse: like -events, with duplicate gates dropped and gates reading a subset of another
+        // gate's inputs merged into its table
+        else if (strcmp(argv[i], "-fuse") == 0)
+        {
+            event_driven = true;
+            fuse_gates = true;
+        }
+        
+        // -df [in file name] [out file name]: create dot image file for given genome
+        else if (strcmp(argv[i], "-df") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            inputGenomeFileName = argv[i];
+            ++i;
+            stringstream dfn;
+            dfn << argv[i];
+            eddDotFileName = dfn.str();
+            make_dot_edd = true;
+        }
+        
+        // -gs [int] [int]: set the digit grid size
+        else if (strcmp(argv[i], "-gs") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            gridSizeX = atoi(argv[i]);
+            ++i;
+            gridSizeY = atoi(argv[i]);
+            
+            if (gridSizeX < 5 || gridSizeY < 5)
+            {
+                cerr << "minimum grid size dimension is 5." << endl;
+                exit(0);
+            }
+            
+            messages << "grid size set to: (" << gridSizeX << ", " << gridSizeY << ")" << endl;
+        }
+        
+        // -zc: allow the edd agent to use a zooming camera
+        else if (strcmp(argv[i], "-zc") == 0)
+        {
+            messages << "zooming camera enabled" << endl;
+            zoomingCamera = true;
+        }
+        
+        // -rp: randomly place the digits within the grid. if randomPlacement = false,
+        // the digits are always centered
+        else if (strcmp(argv[i], "-rp") == 0)
+        {
+            messages << "random placement of digits enabled" << endl;
+            randomPlacement = true;
+        }
+        
+        // -noise [float]: add noise to the edd agent's camera; each input bit is flipped
+        // with the probability given (0.0 = never, 1.0 = always flipped)
+        else if (strcmp(argv[i], "-noise") == 0 && (i + 1) < argc)
+        {
+            noise = true;
+            ++i;
+            noiseAmount = atof(argv[i]);
+            messages << "noise enabled with probability: " << noiseAmount << endl;
+        }
+        
+        // -steps [int]: set the number of brain steps the edd agent gets per digit
+        else if (strcmp(argv[i], "-steps") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            totalSteps = atoi(argv[i]);
+            
+            if (totalSteps < 1)
+            {
+                cerr << "the edd agent needs at least 1 step per digit." << endl;
+                exit(0);
+            }
+            
+            messages << "steps per digit set to: " << totalSteps << endl;
+        }
+        
+        // -nodes [int]: set the number of nodes in the edd agent's brain: 64, 128 or 256
+        else if (strcmp(argv[i], "-nodes") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            brain_nodes = atoi(argv[i]);
+            
+            if (brain_nodes != 64 && brain_nodes != 128 && brain_nodes != 256)
+            {
+                cerr << "brains have 64, 128 or 256 nodes." << endl;
+                exit(0);
+            }
+            
+            messages << "brain nodes set to: " << brain_nodes << endl;
+        }
+        
+        // -ready: let the edd agent end a digit early with its ready actuator
+        else if (strcmp(argv[i], "-ready") == 0)
+        {
+            messages << "ready actuator enabled" << endl;
+            readyActuator = true;
+        }
+        
+        // -speed [float]: like -ready, and add the given fraction of a correct classification's
+        // score, scaled by the share of the digit's steps it saved, to the fitness
+        else if (strcmp(argv[i], "-speed") == 0 && (i + 1) < argc)
+        {
+            readyActuator = true;
+            ++i;
+            speedBonus = atof(argv[i]);
+            messages << "ready actuator enabled with speed bonus: " << speedBonus << endl;
+        }
+        
+        // -dataset [dataset file name]: show random images from the given dataset file instead of the
+        // built-in digits. the grid must be at least as large as its images.
+        else if (strcmp(argv[i], "-dataset") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            dataset_file = argv[i];
+            messages << "digits drawn from dataset: " << dataset_file << endl;
+        }
+        
+        // -batch [int]: with -dataset, show every agent of a generation the same minibatch of the given
+        // number of images of each digit instead of one random image of each digit
+        else if (strcmp(argv[i], "-batch") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            batch_per_digit = atoi(argv[i]);
+            
+            if (batch_per_digit < 1)
+            {
+                cerr << "minibatches have at least 1 image of each digit." << endl;
+                exit(0);
+            }
+            
+            messages << "minibatch of " << batch_per_digit << " image(s) per digit" << endl;
+        }
+        
+        // -fullset [int]: with -batch, score the elites on the whole dataset every [int] generations
+        else if (strcmp(argv[i], "-fullset") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            full_set_frequency = atoi(argv[i]);
+            
+            if (full_set_frequency < 1)
+            {
+                cerr << "minimum full set evaluation frequency is 1." << endl;
+                exit(0);
+            }
+            
+            messages << "elites scored on the full dataset every " << full_set_frequency << " generations" << endl;
+        }
+        
+        // -fullelites [int]: with -batch, the number of best agents scored on the whole dataset
+        else if (strcmp(argv[i], "-fullelites") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            full_set_elites = atoi(argv[i]);
+            
+            if (full_set_elites < 1)
+            {
+                cerr << "at least 1 agent is scored on the full dataset." << endl;
+                exit(0);
+            }
+            
+            messages << full_set_elites << " best agent(s) scored on the full dataset" << endl;
+        }
+        
+        // -augment [int]: show a random variant of every digit, shifted, with thinner or thicker
+        // strokes and dropped or added pixels, keeping up to [int] variants rendered
+        else if (strcmp(argv[i], "-augment") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            augment_cache = atoi(argv[i]);
+            
+            if (augment_cache < 1)
+            {
+                cerr << "the augmentation cache holds at least 1 variant." << endl;
+                exit(0);
+            }
+            
+            messages << "digits augmented, with up to " << augment_cache << " variant(s) cached" << endl;
+        }
+        
+        // -pool [any|majority] [int]: read the camera's view with [int] x [int] sensors at every zoom,
+        // each on if any or most of the pixels of its block are on. the camera can then zoom out
+        // past 9 to the width of the grid
+        else if (strcmp(argv[i], "-pool") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            
+            if (strcmp(argv[i], "any") == 0)
+            {
+                retina_pooling = poolAny;
+            }
+            else if (strcmp(argv[i], "majority") == 0)
+            {
+                retina_pooling = poolMajority;
+            }
+            else
+            {
+                cerr << "pooled sensors are on for any or for a majority of their pixels." << endl;
+                exit(0);
+            }
+            
+            ++i;
+            retina_size = atoi(argv[i]);
+            
+            if (retina_size < 1 || retina_size > 5 || retina_size % 2 == 0)
+            {
+                cerr << "a pooled retina is 1, 3 or 5 sensors wide." << endl;
+                exit(0);
+            }
+            
+            messages << "pooled retina of " << retina_size << "x" << retina_size << " sensors, on for "
+                     << argv[i - 1] << " of their pixels" << endl;
+        }
+        
+        // -p [int]: set the population size:
+        else if (strcmp(argv[i], "-p") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            populationSize = atoi(argv[i]);
+            
+            messages << "population size set to " << populationSize << endl;
+        }
+        
+        // -mr [float]: set the population size:
+        else if (strcmp(argv[i], "-mr") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            perSiteMutationRate = atof(argv[i]);
+            messages << "mutation rate set to " << perSiteMutationRate << endl;
+        }
+        
+        // -rl [int]: use roulette style selection:
+        else if (strcmp(argv[i], "-rl") == 0 && (i + 1) < argc)
+        {
+            i++;
+            roulette_size = atof(argv[i]);
+            roulette = true;
+            tournament = false;
+            messages << "using roulette selection mechanism (" << roulette_size << " per roulette choice)..." << endl;
+        }
+        
+        // -rs: use rank selection:
+        else if (strcmp(argv[i], "-rs") == 0 && (i + 1) < argc)
+        {
+            rank_selection = true;
+            tournament = false;
+            messages << "using rank-selection selection mechanism... " << endl;
+        }
+        
+        // -el: toggle elitism (stores the best genome in addition to the selection mechanism:
+        else if (strcmp(argv[i], "-el") == 0 && (i + 1) < argc)
+        {
+            elitism = true;
+            messages << "using elitism... " << endl;
+        }
+        
+        // -tp [float]: randomly choose an agent from the given top percent of agents:
+        else if (strcmp(argv[i], "-tp") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            percent_select
+            = atof(argv[i]);
+            top_percent = true;
+            tournament = false;
+            messages << "using top percent selection mechanism (top " << percent_select * 100 << "%)..."  << endl;
+        }
+        
+        // -tr [float]: use tournament style selection with a custom sized grouping:
+        else if (strcmp(argv[i], "-tr") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            tourney_size = atof(argv[i]);
+            messages << "using tournament style selection mechanism (" << tourney_size << " agents per selection)..."  << endl;
+        }
+        
+        // -eli [float]: use tournament style selection with a custom sized grouping:
+        else if (strcmp(argv[i], "-eli") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            elite_size = atof(argv[i]);
+            tournament = false;
+            pure_elitism = true;
+            messages << "using pure elitism selection mechanism (" << elite_size << " agents per selection)..."  << endl;
+        }
+        
+        // -workers [int]: evaluate the population on the given number of local worker processes
+        else if (strcmp(argv[i], "-workers") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            farm_local_workers = atoi(argv[i]);
+            messages << "evaluating on " << farm_local_workers << " local worker(s)" << endl;
+        }
+        
+        // -farm [host:port,...]: evaluate the population on workers started with -worker
+        else if (strcmp(argv[i], "-farm") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            farm_addresses = argv[i];
+            messages << "evaluating on workers: " << farm_addresses << endl;
+        }
+        
+        // -fb [int]: number of agents sent to a worker per batch
+        else if (strcmp(argv[i], "-fb") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            farm_batch_size = atoi(argv[i]);
+            
+            if (farm_batch_size < 1)
+            {
+                cerr << "minimum farm batch size is 1." << endl;
+                exit(0);
+            }
+        }
+        
+        // -farmtimeout [int]: seconds a worker may take to answer a batch before it is dropped
+        else if (strcmp(argv[i], "-farmtimeout") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            farm_timeout = atoi(argv[i]);
+            
+            if (farm_timeout < 1)
+            {
+                cerr << "minimum farm timeout is 1 second." << endl;
+                exit(0);
+            }
+            
+            messages << "dropping workers that take over " << farm_timeout << " second(s) to answer a batch" << endl;
+        }
+        
+        // -cp [file name] [int]: checkpoint the whole run every [int] generations
+        // (0 = only when sent SIGUSR1)
+        else if (strcmp(argv[i], "-cp") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            checkpoint_file = argv[i];
+            ++i;
+            checkpoint_frequency = atoi(argv[i]);
+            
+            if (checkpoint_frequency < 0)
+            {
+                cerr << "checkpoint frequency must not be negative." << endl;
+                exit(0);
+            }
+        }
+        
+        // -resume [file name]: continue the run saved in the given checkpoint
+        else if (strcmp(argv[i], "-resume") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            resume_file = argv[i];
+        }
+        
+        // -tobin [out file name] [genome in file names...]: pack text genome files into one binary genome file
+        else if (strcmp(argv[i], "-tobin") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            binary_genome_file = argv[i];
+            
+            while ((i + 1) < argc && argv[i + 1][0] != '-')
+            {
+                ++i;
+                text_genome_files.push_back(argv[i]);
+            }
+        }
+        
+        // -totext [binary genome file name] [out file prefix]: unpack a binary genome file into text genome files
+        else if (strcmp(argv[i], "-totext") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            binary_genome_file = argv[i];
+            ++i;
+            text_genome_prefix = argv[i];
+        }
+        
+        // -idx [images file name] [labels file name] [int] [out file name]: convert IDX images and labels
+        // into a dataset file, with pixels of at least the given value on
+        else if (strcmp(argv[i], "-idx") == 0 && (i + 4) < argc)
+        {
+            ++i;
+            idx_images_file = argv[i];
+            ++i;
+            idx_labels_file = argv[i];
+            ++i;
+            idx_threshold = atoi(argv[i]);
+            ++i;
+            idx_dataset_file = argv[i];
+        }
+        
+        // -seed [binary genome file name]: seed the initial population with the genomes in the given file
+        else if (strcmp(argv[i], "-seed") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            seed_corpus_file = argv[i];
+        }
+        
+        // -worker [port]: serve evaluations to a master on the given TCP port
+        else if (strcmp(argv[i], "-worker") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            worker_port = atoi(argv[i]);
+        }
+        
+        // -metrics [out file name]: write every generation's statistics to a binary metrics file
+        else if (strcmp(argv[i], "-metrics") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            metrics_file = argv[i];
+        }
+        
+        // -aggregate [out file name] [metrics in file names...]: summarize metrics files into a csv file
+        else if (strcmp(argv[i], "-aggregate") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            aggregate_file = argv[i];
+            
+            while ((i + 1) < argc && argv[i + 1][0] != '-')
+            {
+                ++i;
+                aggregate_inputs.push_back(argv[i]);
+            }
+        }
+        
+        // -profile [int]: time the phases of each generation and print a breakdown every
+        // [int] generations (0 = only at the end). needs a build with -DEDD_PROFILE, as build_edd does
+        else if (strcmp(argv[i], "-profile") == 0 && (i + 1) < argc)
+        {
+            profile = true;
+            ++i;
+            profile_interval = atoi(argv[i]);
+            
+            if (profile_interval < 0)
+            {
+                cerr << "profile interval must not be negative." << endl;
+                exit(0);
+            }
+        }
+        
+        // -perf: also count cycles, instructions, L1 data cache misses and branch misses in
+        // each phase with the CPU's performance counters, where the system allows it
+        else if (strcmp(argv[i], "-perf") == 0)
+        {
+            profile = true;
+            profile_hardware = true;
+        }
+        
+        // -trace [file name]: record a timeline of the run and the evaluation threads, written
+        // as Chrome trace JSON at exit and on SIGUSR2
+        else if (strcmp(argv[i], "-trace") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            trace_file = argv[i];
+        }
+        
+        // -sweep [parameter file] [out directory] [int]: run every configuration in the
+        // parameter file, using at most [int] cores
+        else if (strcmp(argv[i], "-sweep") == 0 && (i + 3) < argc)
+        {
+            ++i;
+            sweep_file = argv[i];
+            ++i;
+            sweep_directory = argv[i];
+            ++i;
+            sweep_cores = atoi(argv[i]);
+            
+            if (sweep_cores < 1)
+            {
+                cerr << "minimum number of sweep cores is 1." << endl;
+                exit(0);
+            }
+        }
+        
+        // -bench [int]: evolve for [int] generations with a fixed seed and report the throughput
+        else if (strcmp(argv[i], "-bench") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            bench_generations = atoi(argv[i]);
+            
+            if (bench_generations < 1)
+            {
+                cerr << "minimum number of benchmark generations is 1." << endl;
+                exit(0);
+            }
+        }
+        
+        // -baseline [file name] [float]: compare a -bench run with a saved one; a throughput
+        // more than [float] (e.g. 0.05 = 5%) below the baseline is a regression
+        else if (strcmp(argv[i], "-baseline") == 0 && (i + 2) < argc)
+        {
+            ++i;
+            bench_baseline_file = argv[i];
+            ++i;
+            bench_threshold = atof(argv[i]);
+            
+            if (bench_threshold < 0.0)
+            {
+                cerr << "regression threshold must not be negative." << endl;
+                exit(0);
+            }
+        }
+        
+        // -savebaseline [file name]: save the results of a -bench run as a baseline
+        else if (strcmp(argv[i], "-savebaseline") == 0 && (i + 1) < argc)
+        {
+            ++i;
+            bench_save_file = argv[i];
+        }
+        
+    }
+}
+        
+// places relative file names in the output directory, if there is one
+string tConfig::outputPath(const string &fileName) const
+{
+    if (outputDirectory == "" || fileName == "" || fileName[0] == '/')
+    {
+        return fileName;
+    }
+    
+    return outputDirectory + "/" + fileName;
+}
+
+// the parameters of the game and the brain that change what a run evolves,
+// written the way they are given on the command line, e.g. to tell apart
+// runs in a metrics summary
+string tConfig::gameParameters(void) const
+{
+    stringstream parameters;
+    parameters << "-gs " << gridSizeX << " " << gridSizeY << " -nodes " << brain_nodes << " -steps " << totalSteps;
+    
+    if (zoomingCamera)
+    {
+        parameters << " -zc";
+    }
+    
+    if (randomPlacement)
+    {
+        parameters << " -rp";
+    }
+    
+    if (noise)
+    {
+        parameters << " -noise " << noiseAmount;
+    }
+    
+    if (readyActuator)
+    {
+        parameters << " -ready";
+    }
+    
+    if (speedBonus != 0.0)
+    {
+        parameters << " -speed " << speedBonus;
+    }
+    
+    if (retina_pooling != poolNone)
+    {
+        parameters << " -pool " << ((retina_pooling == poolAny) ? "any " : "majority ") << retina_size;
+    }
+    
+    if (augment_cache > 0)
+    {
+        parameters << " -augment";
+    }
+    
+    if (dataset_file != "")
+    {
+        parameters << " -dataset " << dataset_file;
+    }
+    
+    if (dataset_file != "" && batch_per_digit > 0)
+    {
+        parameters << " -batch " << batch_per_digit << " -fullset " << full_set_frequency << " -fullelites " << full_set_elites;
+    }
+    
+    return parameters.str();
+}
@@ -0,0 +1,144 @@
+/*
+ * tConfig.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tConfig_h_included_
+#define _tConfig_h_included_
+
+#include <vector>
+#include <string>
+#include <iostream>
+
+using namespace std;
+
+// every setting of a run. the command line fills in one of these, and a sweep
+// fills in one per line of its parameter file.
+class tConfig
+{
+public:
+    // evolution
+    double  perSiteMutationRate;
+    int     populationSize;
+    int     totalGenerations;
+    unsigned int randomSeed;
+    bool    random_seed_set;
+    string  LODFileName, eddGenomeFileName;
+    int     lod_replicates;
+
+    // videos and snapshots
+    bool    make_interval_video;
+    int     make_video_frequency;
+    bool    make_LOD_video;
+    bool    track_best_brains;
+    int     track_best_brains_frequency;
+
+    // one-off modes
+    bool    display_only;
+    bool    display_directory;
+    bool    make_logic_table;
+    bool    make_dot_edd;
+    bool    make_logic_network;
+    bool    compile_logic;
+    string  native_directory;
+    bool    event_driven;
+    bool    fuse_gates;
+    string  inputGenomeFileName, visualizationFileName, displayDirectory;
+    string  logicTableFileName, eddDotFileName, logicNetworkFileName;
+    vector<int> logic_inputs, logic_outputs;
+    string  idx_images_file, idx_labels_file, idx_dataset_file;
+    int     idx_threshold;
+
+    // the game
+    int     gridSizeX;
+    int     gridSizeY;
+    bool    zoomingCamera;
+    bool    randomPlacement;
+    bool    noise;
+    float   noiseAmount;
+    int     totalSteps;
+    bool    readyActuator;
+    double  speedBonus;
+    int     brain_nodes;
+    string  dataset_file;
+    int     batch_per_digit;
+    int     full_set_frequency;
+    int     full_set_elites;
+    int     augment_cache;
+    int     retina_pooling;
+    int     retina_size;
+
+    // selection
+    bool    tournament;
+    bool    roulette;
+    bool    pure_elitism;
+    int     roulette_size;
+    bool    rank_selection;
+    bool    elitism;
+    bool    top_percent;
+    float   percent_select;
+    int     tourney_size;
+    int     elite_size;
+
+    // evaluation farm
+    int     farm_local_workers;
+    string  farm_addresses;
+    int     farm_batch_size;
+    int     farm_timeout;
+    int     worker_port;
+
+    // checkpoints and genome files
+    string  checkpoint_file;
+    int     checkpoint_frequency;
+    string  resume_file;
+    string  binary_genome_file;
+    vector<string> text_genome_files;
+    string  text_genome_prefix;
+    string  seed_corpus_file;
+
+    // metrics
+    string  metrics_file;
+    string  aggregate_file;
+    vector<string> aggregate_inputs;
+    bool    profile;
+    int     profile_interval;
+    bool    profile_hardware;
+    string  trace_file;
+
+    // throughput benchmark
+    int     bench_generations;
+    string  bench_baseline_file, bench_save_file;
+    double  bench_threshold;
+
+    // sweeps
+    string  sweep_file, sweep_directory;
+    int     sweep_cores;
+
+    // where the run's files go (relative names are placed in it) and where
+    // its progress is printed
+    string  outputDirectory;
+    ostream *out;
+
+    tConfig();
+    void parseArguments(int argc, char *argv[], ostream &messages);
+    string outputPath(const string &fileName) const;
+    string gameParameters(void) const;
+};
+
+#endif
@@ -0,0 +1,369 @@
+/*
+ * tDataset.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tDataset.h"
+#include "tRandom.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <iostream>
+#include <string>
+#include <map>
+#include <mutex>
+
+static const char datasetFileMagic[8] = { 'E', 'D', 'D', 'D', 'I', 'G', 'I', 'T' };
+
+tDataset::tDataset()
+{
+    base = NULL;
+    mappedSize = 0;
+    header = NULL;
+    labels = NULL;
+    images = NULL;
+}
+
+tDataset::~tDataset()
+{
+    close();
+}
+
+bool tDataset::open(const char *filename)
+{
+    close();
+
+    int fd = ::open(filename, O_RDONLY);
+
+    if (fd < 0)
+    {
+        perror(filename);
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(tDatasetHeader))
+    {
+        cerr << "invalid dataset file: " << filename << endl;
+        ::close(fd);
+        return false;
+    }
+
+    // shared and read-only, so every process mapping the file uses the same pages
+    void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        perror(filename);
+        return false;
+    }
+
+    base = (const unsigned char *)mapped;
+    mappedSize = info.st_size;
+    header = (const tDatasetHeader *)base;
+
+    bool valid = memcmp(header->magic, datasetFileMagic, sizeof(datasetFileMagic)) == 0 &&
+                 header->version == datasetFileVersion && header->headerSize == sizeof(tDatasetHeader) &&
+                 header->fileSize == mappedSize && header->width > 0 && header->height > 0 &&
+                 header->wordsPerImage == (header->width * header->height + 63) / 64 &&
+                 header->labelsOffset + header->count <= header->imagesOffset && header->imagesOffset % 8 == 0 &&
+                 header->imagesOffset + (uint64_t)header->count * header->wordsPerImage * 8 <= mappedSize;
+
+    if (valid)
+    {
+        labels = base + header->labelsOffset;
+        images = (const uint64_t *)(base + header->imagesOffset);
+
+        for (uint32_t i = 0; i < header->count && valid; ++i)
+        {
+            valid = labels[i] <= 9;
+
+            if (valid)
+            {
+                byDigit[labels[i]].push_back(i);
+            }
+        }
+    }
+
+    // every game shows one image of each digit
+    for (int digit = 0; digit < 10 && valid; ++digit)
+    {
+        valid = !byDigit[digit].empty();
+    }
+
+    if (!valid)
+    {
+        cerr << "invalid dataset file: " << filename << endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void tDataset::close(void)
+{
+    if (base != NULL)
+    {
+        munmap((void *)base, mappedSize);
+    }
+
+    base = NULL;
+    mappedSize = 0;
+    header = NULL;
+    labels = NULL;
+    images = NULL;
+
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        byDigit[digit].clear();
+    }
+}
+
+uint32_t tDataset::size(void) const
+{
+    return (header == NULL) ? 0 : header->count;
+}
+
+int tDataset::width(void) const
+{
+    return header->width;
+}
+
+int tDataset::height(void) const
+{
+    return header->height;
+}
+
+int tDataset::label(uint32_t i) const
+{
+    return labels[i];
+}
+
+const uint64_t *tDataset::image(uint32_t i) const
+{
+    return images + (size_t)i * header->wordsPerImage;
+}
+
+const vector<uint32_t> &tDataset::imagesOf(int digit) const
+{
+    return byDigit[digit];
+}
+
+static uint64_t greatestCommonDivisor(uint64_t a, uint64_t b)
+{
+    while (b != 0)
+    {
+        uint64_t remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+
+    return a;
+}
+
+// the images of a generation's minibatch: perDigit images of every digit, in
+// digit order. each digit's images are visited in an order that depends only
+// on seed, with consecutive generations taking consecutive runs of it, so
+// every image is shown once per pass. each pass is a different affine
+// permutation of the digit's images, so nothing but the batch is computed.
+void tDataset::minibatch(int perDigit, unsigned int seed, long long generation, vector<uint32_t> &batch) const
+{
+    batch.clear();
+
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        const vector<uint32_t> &images = byDigit[digit];
+        uint64_t count = images.size();
+
+        for (int i = 0; i < perDigit; ++i)
+        {
+            uint64_t position = (uint64_t)generation * perDigit + i;
+            uint64_t pass = position / count;
+            uint64_t hash = eddMixBits(eddMixBits(((uint64_t)seed << 32) ^ (pass << 4) ^ digit));
+
+            // a step coprime with count visits every image once
+            uint64_t offset = hash % count, step = 1 + (hash >> 32) % count;
+
+            while (greatestCommonDivisor(step, count) != 1)
+            {
+                ++step;
+            }
+
+            batch.push_back(images[(offset + (position % count) * step) % count]);
+        }
+    }
+}
+
+// the dataset in the given file, mapped once per process however many runs
+// and threads use it. NULL if the file is not a valid dataset.
+const tDataset *tDataset::shared(const char *filename)
+{
+    static mutex datasetsLock;
+    static map<string, tDataset*> datasets;
+
+    lock_guard<mutex> lock(datasetsLock);
+    map<string, tDataset*>::iterator found = datasets.find(filename);
+
+    if (found != datasets.end())
+    {
+        return found->second;
+    }
+
+    tDataset *dataset = new tDataset;
+
+    if (!dataset->open(filename))
+    {
+        delete dataset;
+        return NULL;
+    }
+
+    datasets[filename] = dataset;
+    return dataset;
+}
+
+// reads a whole IDX file, checking its type and number of dimensions. the
+// dimensions are big-endian, as the format defines them.
+static bool readIdx(const char *filename, unsigned char type, int dimensions, vector<uint32_t> &sizes,
+                    vector<unsigned char> &data)
+{
+    FILE *f = fopen(filename, "rb");
+
+    if (f == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+
+    unsigned char magic[4];
+    bool ok = fread(magic, 1, 4, f) == 4 && magic[0] == 0 && magic[1] == 0 && magic[2] == type && magic[3] == dimensions;
+    uint64_t length = 1;
+
+    sizes.resize(dimensions);
+
+    for (int d = 0; d < dimensions && ok; ++d)
+    {
+        unsigned char size[4];
+        ok = fread(size, 1, 4, f) == 4;
+        sizes[d] = ((uint32_t)size[0] << 24) | ((uint32_t)size[1] << 16) | ((uint32_t)size[2] << 8) | size[3];
+        length *= sizes[d];
+    }
+
+    if (ok)
+    {
+        data.resize(length);
+        ok = length == 0 || fread(&data[0], 1, length, f) == length;
+    }
+
+    fclose(f);
+
+    if (!ok)
+    {
+        cerr << "invalid IDX file: " << filename << endl;
+    }
+
+    return ok;
+}
+
+// writes an IDX image file (unsigned bytes, images x rows x columns) and its
+// IDX label file as a dataset file, with pixels of at least threshold on
+bool tDataset::convert(const char *imagesFile, const char *labelsFile, int threshold, const char *filename)
+{
+    vector<uint32_t> imageSizes, labelSizes;
+    vector<unsigned char> pixels, imageLabels;
+
+    if (!readIdx(imagesFile, 0x08, 3, imageSizes, pixels) || !readIdx(labelsFile, 0x08, 1, labelSizes, imageLabels))
+    {
+        return false;
+    }
+
+    if (imageSizes[0] != labelSizes[0])
+    {
+        cerr << imagesFile << " has " << imageSizes[0] << " images but " << labelsFile << " has "
+             << labelSizes[0] << " labels" << endl;
+        return false;
+    }
+
+    tDatasetHeader fileHeader;
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    memcpy(fileHeader.magic, datasetFileMagic, sizeof(datasetFileMagic));
+    fileHeader.version = datasetFileVersion;
+    fileHeader.headerSize = sizeof(fileHeader);
+    fileHeader.count = imageSizes[0];
+    fileHeader.height = imageSizes[1];
+    fileHeader.width = imageSizes[2];
+    fileHeader.wordsPerImage = (fileHeader.width * fileHeader.height + 63) / 64;
+    fileHeader.labelsOffset = sizeof(fileHeader);
+    fileHeader.imagesOffset = (fileHeader.labelsOffset + fileHeader.count + 7) & ~(uint64_t)7;
+    fileHeader.fileSize = fileHeader.imagesOffset + (uint64_t)fileHeader.count * fileHeader.wordsPerImage * 8;
+
+    uint32_t pixelsPerImage = fileHeader.width * fileHeader.height;
+    vector<uint64_t> bitboards((size_t)fileHeader.count * fileHeader.wordsPerImage, 0);
+
+    for (uint32_t i = 0; i < fileHeader.count; ++i)
+    {
+        if (imageLabels[i] > 9)
+        {
+            cerr << labelsFile << ": image " << i << " is labeled " << (int)imageLabels[i] << endl;
+            return false;
+        }
+
+        const unsigned char *imagePixels = &pixels[(size_t)i * pixelsPerImage];
+        uint64_t *bitboard = &bitboards[(size_t)i * fileHeader.wordsPerImage];
+
+        for (uint32_t bit = 0; bit < pixelsPerImage; ++bit)
+        {
+            if (imagePixels[bit] >= threshold)
+            {
+                bitboard[bit >> 6] |= 1ULL << (bit & 63);
+            }
+        }
+    }
+
+    FILE *f = fopen(filename, "wb");
+
+    if (f == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+    const char padding[8] = { 0 };
+    size_t paddingLength = fileHeader.imagesOffset - fileHeader.labelsOffset - fileHeader.count;
+
+    bool ok = fwrite(&fileHeader, sizeof(fileHeader), 1, f) == 1;
+    ok = ok && (fileHeader.count == 0 || fwrite(&imageLabels[0], 1, fileHeader.count, f) == fileHeader.count);
+    ok = ok && fwrite(padding, 1, paddingLength, f) == paddingLength;
+    ok = ok && (bitboards.empty() || fwrite(&bitboards[0], sizeof(uint64_t), bitboards.size(), f) == bitboards.size());
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok)
+    {
+        perror(filename);
+    }
+
+    return ok;
+}
@@ -0,0 +1,78 @@
+/*
+ * tDataset.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tDataset_h_included_
+#define _tDataset_h_included_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+using namespace std;
+
+#define     datasetFileVersion  1
+
+// binarized digit images: a header, one label byte per image and every image
+// as a bitboard of wordsPerImage words. pixel (x, y), with y = 0 the top row
+// as in IDX files, is bit (y * width + x) of the image. everything is used in
+// place after mapping the file.
+struct tDatasetHeader
+{
+    char magic[8];
+    uint32_t version, headerSize;
+    uint32_t count, width, height, wordsPerImage;
+    uint64_t labelsOffset, imagesOffset, fileSize;
+};
+
+class tDataset
+{
+public:
+    tDataset();
+    ~tDataset();
+    bool open(const char *filename);
+    void close(void);
+    uint32_t size(void) const;
+    int width(void) const;
+    int height(void) const;
+    int label(uint32_t i) const;
+    const uint64_t *image(uint32_t i) const;
+    const vector<uint32_t> &imagesOf(int digit) const;
+    void minibatch(int perDigit, unsigned int seed, long long generation, vector<uint32_t> &batch) const;
+
+    bool pixel(uint32_t i, int x, int y) const
+    {
+        uint32_t bit = y * header->width + x;
+        return (images[i * header->wordsPerImage + (bit >> 6)] >> (bit & 63)) & 1;
+    }
+
+    static const tDataset *shared(const char *filename);
+    static bool convert(const char *imagesFile, const char *labelsFile, int threshold, const char *filename);
+
+private:
+    const unsigned char *base;
+    size_t mappedSize;
+    const tDatasetHeader *header;
+    const unsigned char *labels;
+    const uint64_t *images;
+    vector<uint32_t> byDigit[10];
+};
+
+#endif
@@ -0,0 +1,304 @@
+/*
+ * tEventBrain.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tEventBrain.h"
+#include "tHMM.h"
+#include "tLogic.h"
+#include <string.h>
+#include <algorithm>
+
+thread_local bool eventDrivenBrains = false;
+thread_local bool fuseEventGates = false;
+
+// fails on stochastic brains
+bool tEventBrain::build(const vector<tHMMU*> &hmmus, bool fuse)
+{
+    gates.resize(hmmus.size());
+    sourceGates = (int)hmmus.size();
+    duplicateGates = 0;
+    fusedGates = 0;
+    
+    for (int g = 0; g < hmmus.size(); ++g)
+    {
+        tHMMU *gate = hmmus[g];
+        tEventGate &eventGate = gates[g];
+        
+        eventGate.inputCount = (unsigned char)gate->ins.size();
+        eventGate.outputCount = (unsigned char)gate->outs.size();
+        eventGate.output = 0;
+        eventGate.distinctInputs = 0;
+        
+        for (int i = 0; i < eventGate.inputCount; ++i)
+        {
+            eventGate.ins[i] = (unsigned char)gate->ins[i];
+            
+            if (memchr(eventGate.ins, eventGate.ins[i], i) == NULL)
+            {
+                ++eventGate.distinctInputs;
+            }
+        }
+        
+        for (int o = 0; o < eventGate.outputCount; ++o)
+        {
+            eventGate.outs[o] = (unsigned char)gate->outs[o];
+        }
+        
+        for (int row = 0; row < (1 << eventGate.inputCount); ++row)
+        {
+            int output = deterministicOutput(gate, row);
+            
+            if (output < 0)
+            {
+                return false;
+            }
+            
+            eventGate.rows[row] = (unsigned short)output;
+        }
+    }
+    
+    if (fuse)
+    {
+        this->fuse();
+    }
+    
+    // the gates reading each node, each gate listed once per node
+    fanOutStart.assign(brainNodes + 1, 0);
+    fanOut.clear();
+    
+    for (int node = 0; node < brainNodes; ++node)
+    {
+        for (int g = 0; g < gates.size(); ++g)
+        {
+            if (memchr(gates[g].ins, node, gates[g].inputCount) != NULL)
+            {
+                fanOut.push_back(g);
+            }
+        }
+        
+        fanOutStart[node + 1] = (int)fanOut.size();
+    }
+    
+    dirty.clear();
+    queued.assign(gates.size(), 0);
+    primed = false;
+    
+    return true;
+}
+
+bool tEventBrain::sameGate(const tEventGate &a, const tEventGate &b)
+{
+    return a.inputCount == b.inputCount && a.outputCount == b.outputCount
+        && memcmp(a.ins, b.ins, a.inputCount) == 0 && memcmp(a.outs, b.outs, a.outputCount) == 0
+        && memcmp(a.rows, b.rows, (1 << a.inputCount) * sizeof(a.rows[0])) == 0;
+}
+
+// whether wider reads every node gate reads
+bool tEventBrain::readsAll(const tEventGate &wider, const tEventGate &gate)
+{
+    for (int i = 0; i < gate.inputCount; ++i)
+    {
+        if (memchr(wider.ins, gate.ins[i], wider.inputCount) == NULL)
+        {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// drops duplicate gates, then merges each gate into the first wider gate that
+// reads all of its inputs. a node is on if any gate output switches it on, so
+// neither changes the states.
+void tEventBrain::fuse(void)
+{
+    vector<tEventGate> unique;
+    
+    for (int g = 0; g < gates.size(); ++g)
+    {
+        bool duplicate = false;
+        
+        for (int u = 0; u < unique.size() && !duplicate; ++u)
+        {
+            duplicate = sameGate(gates[g], unique[u]);
+        }
+        
+        if (duplicate)
+        {
+            ++duplicateGates;
+        }
+        else
+        {
+            unique.push_back(gates[g]);
+        }
+    }
+    
+    // gates reading the most nodes first, so that they are there to merge into
+    stable_sort(unique.begin(), unique.end(), [](const tEventGate &a, const tEventGate &b)
+    {
+        return a.distinctInputs > b.distinctInputs;
+    });
+    
+    gates.clear();
+    
+    for (int u = 0; u < unique.size(); ++u)
+    {
+        const tEventGate &gate = unique[u];
+        int into = -1;
+        
+        for (int g = 0; g < gates.size() && into < 0; ++g)
+        {
+            if (readsAll(gates[g], gate) && gates[g].outputCount + gate.outputCount <= maxFusedOutputs)
+            {
+                into = g;
+            }
+        }
+        
+        if (into < 0)
+        {
+            gates.push_back(gate);
+            continue;
+        }
+        
+        // the bit of the wider gate's row holding each of the gate's inputs
+        tEventGate &wider = gates[into];
+        int bits[4];
+        
+        for (int i = 0; i < gate.inputCount; ++i)
+        {
+            int position = (int)((const unsigned char *)memchr(wider.ins, gate.ins[i], wider.inputCount) - wider.ins);
+            bits[i] = wider.inputCount - 1 - position;
+        }
+        
+        for (int row = 0; row < (1 << wider.inputCount); ++row)
+        {
+            int gateRow = 0;
+            
+            for (int i = 0; i < gate.inputCount; ++i)
+            {
+                gateRow = (gateRow << 1) | ((row >> bits[i]) & 1);
+            }
+            
+            wider.rows[row] |= gate.rows[gateRow] << wider.outputCount;
+        }
+        
+        memcpy(wider.outs + wider.outputCount, gate.outs, gate.outputCount);
+        wider.outputCount += gate.outputCount;
+        ++fusedGates;
+    }
+}
+
+void tEventBrain::evaluate(int gate, const unsigned char *states)
+{
+    tEventGate &eventGate = gates[gate];
+    int row = 0;
+    
+    for (int i = 0; i < eventGate.inputCount; ++i)
+    {
+        row = (row << 1) | (states[eventGate.ins[i]] & 1);
+    }
+    
+    int output = eventGate.rows[row];
+    int changed = output ^ eventGate.output;
+    
+    for (int o = 0; changed != 0; ++o, changed >>= 1)
+    {
+        if (changed & 1)
+        {
+            nodeCounts[eventGate.outs[o]] += ((output >> o) & 1) ? 1 : -1;
+        }
+    }
+    
+    eventGate.output = (unsigned short)output;
+}
+
+// one step of the brain on states, in place. returns the number of gates
+// evaluated: all of them on the first step, then only those with an input
+// that differs from the states of the last step, whether the brain or the
+// game changed it.
+int tEventBrain::update(unsigned char *states)
+{
+    int evaluated;
+    
+    if (!primed)
+    {
+        memset(nodeCounts, 0, sizeof(nodeCounts));
+        
+        for (int g = 0; g < gates.size(); ++g)
+        {
+            gates[g].output = 0;
+            evaluate(g, states);
+        }
+        
+        evaluated = (int)gates.size();
+        primed = true;
+    }
+    else
+    {
+        // compare 8 nodes at a time; most words have not changed
+        for (int word = 0; word < brainNodes; word += 8)
+        {
+            uint64_t now, before;
+            memcpy(&now, states + word, 8);
+            memcpy(&before, lastStates + word, 8);
+            
+            if (now == before)
+            {
+                continue;
+            }
+            
+            for (int node = word; node < word + 8; ++node)
+            {
+                if (states[node] == lastStates[node])
+                {
+                    continue;
+                }
+                
+                for (int f = fanOutStart[node]; f < fanOutStart[node + 1]; ++f)
+                {
+                    if (!queued[fanOut[f]])
+                    {
+                        queued[fanOut[f]] = 1;
+                        dirty.push_back(fanOut[f]);
+                    }
+                }
+            }
+        }
+        
+        for (int d = 0; d < dirty.size(); ++d)
+        {
+            evaluate(dirty[d], states);
+            queued[dirty[d]] = 0;
+        }
+        
+        evaluated = (int)dirty.size();
+        dirty.clear();
+    }
+    
+    // the gates now hold their outputs for these inputs
+    memcpy(lastStates, states, brainNodes);
+    
+    for (int node = 0; node < brainNodes; ++node)
+    {
+        states[node] = (nodeCounts[node] > 0);
+    }
+    
+    return evaluated;
+}
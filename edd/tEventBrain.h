@@ -0,0 +1,82 @@
+/*
+ * tEventBrain.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tEventBrain_h_included_
+#define _tEventBrain_h_included_
+
+#include <stdint.h>
+#include <vector>
+#include "globalConst.h"
+
+using namespace std;
+
+class tHMMU;
+
+// play this thread's deterministic brains with tEventBrain (-events), with
+// their gates fused (-fuse)
+extern thread_local bool eventDrivenBrains;
+extern thread_local bool fuseEventGates;
+
+#define     maxFusedOutputs     16
+
+// event-driven updates of a deterministic brain. between two steps most nodes
+// keep their value, so only the gates reading a node that changed are
+// evaluated again; every other gate keeps the output it chose last time. each
+// node counts the gate outputs currently switching it on, and is on while the
+// count is not zero. the next states are exactly those of the gates.
+//
+// fused, identical gates are kept once and every gate whose inputs are among
+// those of another gate is merged into that gate's table, which then writes
+// the outputs of both: one lookup where there were several.
+class tEventBrain
+{
+public:
+    int sourceGates, duplicateGates, fusedGates;
+
+    bool build(const vector<tHMMU*> &hmmus, bool fuse = false);
+    int tables(void) const { return (int)gates.size(); }
+    int update(unsigned char *states);
+
+private:
+    struct tEventGate
+    {
+        unsigned char ins[4], outs[maxFusedOutputs];
+        unsigned char inputCount, outputCount;
+        unsigned short output;
+        unsigned short rows[16];
+        unsigned char distinctInputs;
+    };
+
+    static bool sameGate(const tEventGate &a, const tEventGate &b);
+    static bool readsAll(const tEventGate &wider, const tEventGate &gate);
+    void fuse(void);
+    void evaluate(int gate, const unsigned char *states);
+
+    vector<tEventGate> gates;
+    vector<int> fanOutStart, fanOut;
+    vector<int> dirty;
+    vector<unsigned char> queued;
+    int nodeCounts[maxNodes];
+    unsigned char lastStates[maxNodes];
+    bool primed;
+};
+
+#endif
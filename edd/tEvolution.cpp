@@ -0,0 +1,1231 @@
+/*
+ * tEvolution.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson, Arend Hintze.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tEvolution.h"
+#include "tHMM.h"
+#include "tGame.h"
+#include "tFarm.h"
+#include "tCheckpoint.h"
+#include "tGenomeFile.h"
+#include "tDataset.h"
+#include "tMetrics.h"
+#include "tProfile.h"
+#include "tTrace.h"
+#include "tNative.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+#include <math.h>
+#include <signal.h>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+// SIGUSR1 asks every run with a checkpoint file to write a checkpoint. each
+// run remembers how many requests it has already served.
+static volatile sig_atomic_t checkpoint_requests = 0;
+
+static void requestCheckpoint(int signal)
+{
+    checkpoint_requests = checkpoint_requests + 1;
+}
+
+// shuffles the population in place, with the run's random number generator
+static void shuffleAgents(vector<tAgent*> &agents)
+{
+    PROFILE_SCOPE(phaseShuffle);
+    random_shuffle(agents.begin(), agents.end(), tRandomShuffle());
+}
+
+// takes agent out of the population. it lives on without its phenotype as
+// long as it is the ancestor of an agent that does
+static void retireAgent(tAgent *agent)
+{
+    agent->nrPointingAtMe--;
+    
+    if (agent->nrPointingAtMe == 0)
+    {
+        delete agent;
+    }
+    else
+    {
+        agent->releasePhenotype();
+    }
+}
+
+// runs task on as many threads as there are cores, or tasks if fewer; each
+// thread takes tasks until there are none left
+static void runOnAllCores(int tasks, const function<void()> &task)
+{
+    int threadCount = max(1, min((int)thread::hardware_concurrency(), tasks));
+    vector<thread> threads;
+    
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.push_back(thread(task));
+    }
+    
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads[t].join();
+    }
+}
+
+// the fitness of every agent of a line of descent, oldest first. consecutive
+// ancestors often share a phenotype, so each distinct phenotype plays
+// lod_replicates games once, on all cores. every game is seeded from the
+// phenotype and the run's seed, so the fitnesses do not depend on the number
+// of threads. the agents are only read. returns the brain steps taken.
+static unsigned long long analyzeLineOfDescent(const vector<tAgent*> &lineage, tGame *game, const tConfig &config,
+                                               vector<double> &fitness)
+{
+    int count = (int)lineage.size();
+    int nodes = brainNodes;
+    bool events = eventDrivenBrains, fuse = fuseEventGates;
+    vector<unsigned long long> hashes(count);
+    atomic<int> next(0);
+    atomic<unsigned long long> steps(0);
+    
+    auto hashPhenotypes = [&]()
+    {
+        brainNodes = nodes;
+        eventDrivenBrains = events;
+        fuseEventGates = fuse;
+        tAgent agent;
+        
+        for (int a = next++; a < count; a = next++)
+        {
+            agent.genome = lineage[a]->genome;
+            agent.setupPhenotype();
+            hashes[a] = agent.phenotypeHash();
+        }
+    };
+    
+    runOnAllCores(count, hashPhenotypes);
+    
+    // the first ancestor with each phenotype stands for all of them
+    map<unsigned long long, int> phenotypeIndex;
+    vector<int> phenotypeOf(count), representatives;
+    
+    for (int a = 0; a < count; ++a)
+    {
+        map<unsigned long long, int>::iterator found = phenotypeIndex.find(hashes[a]);
+        
+        if (found == phenotypeIndex.end())
+        {
+            found = phenotypeIndex.insert(make_pair(hashes[a], (int)representatives.size())).first;
+            representatives.push_back(a);
+        }
+        
+        phenotypeOf[a] = found->second;
+    }
+    
+    vector<double> phenotypeFitness(representatives.size(), 0.0);
+    next = 0;
+    
+    auto playPhenotypes = [&]()
+    {
+        brainNodes = nodes;
+        eventDrivenBrains = events;
+        fuseEventGates = fuse;
+        tGame lodGame(*game);
+        lodGame.brainSteps = 0;
+        lodGame.stateTrace = NULL;
+        
+        for (int p = next++; p < representatives.size(); p = next++)
+        {
+            tAgent agent;
+            agent.genome = lineage[representatives[p]]->genome;
+            agent.born = lineage[representatives[p]]->born;
+            
+            if (config.compile_logic)
+            {
+                agent.setupPhenotype();
+                agent.compileLogic();
+            }
+            
+            if (config.native_directory != "")
+            {
+                compileNative(&agent, config.native_directory);
+            }
+            
+            for (int replicate = 0; replicate < config.lod_replicates; ++replicate)
+            {
+                eddSrand((unsigned int)eddMixBits(hashes[representatives[p]] ^ ((uint64_t)config.randomSeed << 32) ^ replicate));
+                lodGame.executeGame(&agent, NULL, false, config.gridSizeX, config.gridSizeY, config.zoomingCamera, config.randomPlacement, config.noise, config.noiseAmount);
+                phenotypeFitness[p] += agent.fitness;
+            }
+            
+            phenotypeFitness[p] /= config.lod_replicates;
+        }
+        
+        steps += lodGame.brainSteps;
+    };
+    
+    runOnAllCores((int)representatives.size(), playPhenotypes);
+    
+    fitness.resize(count);
+    
+    for (int a = 0; a < count; ++a)
+    {
+        fitness[a] = phenotypeFitness[phenotypeOf[a]];
+    }
+    
+    return steps;
+}
+
+// FNV-1a hash of every agent's genome and fitnesses, in population order.
+// two runs with the same fingerprint evolved exactly the same population.
+static unsigned long long populationFingerprint(const vector<tAgent*> &agents)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    
+    for (int i = 0; i < agents.size(); ++i)
+    {
+        unsigned long long length = agents[i]->genome.size();
+        const unsigned char *fields[4] = { (const unsigned char *)&length, agents[i]->genome.data(),
+                                           (const unsigned char *)&agents[i]->fitness, (const unsigned char *)&agents[i]->classificationFitness };
+        size_t sizes[4] = { sizeof(length), agents[i]->genome.size(), sizeof(agents[i]->fitness), sizeof(agents[i]->classificationFitness) };
+        
+        for (int field = 0; field < 4; ++field)
+        {
+            for (size_t byte = 0; byte < sizes[field]; ++byte)
+            {
+                hash = (hash ^ fields[field][byte]) * 1099511628211ULL;
+            }
+        }
+    }
+    
+    return hash;
+}
+
+// evolves a population with the given configuration and returns its results.
+// everything the run needs lives here or in its configuration, so several
+// runs can go on side by side in different threads.
+tRunSummary runEvolution(tConfig &config)
+{
+    tRunSummary summary;
+    ostream &out = *config.out;
+    chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+    
+    vector<tAgent*> eddAgents, EANextGen;
+    tAgent *eddAgent = NULL, *bestEddAgent = NULL;
+    double eddMaxFitness = 0.0;
+    tFarm *farm = NULL;
+    int checkpointRequestsSeen = checkpoint_requests;
+    
+    eddSrand(config.randomSeed);
+    masterID = 0;
+    brainNodes = config.brain_nodes;
+    eventDrivenBrains = config.event_driven;
+    fuseEventGates = config.fuse_gates;
+    eddAgents.resize(config.populationSize);
+    
+    if (config.outputDirectory != "")
+    {
+        traceSetThreadName(config.outputDirectory.c_str());
+    }
+    
+    // set up the simulation
+    tGame *game = new tGame;
+    game->totalSteps = config.totalSteps;
+    game->readyActuator = config.readyActuator;
+    game->speedBonus = config.speedBonus;
+    game->retinaPooling = config.retina_pooling;
+    game->retinaSize = config.retina_size;
+    
+    if (config.dataset_file != "" && !game->loadDataset(config.dataset_file.c_str(), config.gridSizeX, config.gridSizeY))
+    {
+        delete game;
+        return summary;
+    }
+    
+    if (!game->setAugmentation(config.augment_cache))
+    {
+        delete game;
+        return summary;
+    }
+    
+    if (config.batch_per_digit > 0 && game->dataset == NULL)
+    {
+        cerr << "-batch needs a dataset (-dataset)." << endl;
+        delete game;
+        return summary;
+    }
+    
+    // the generation's minibatch, every image of the dataset for scoring the
+    // elites, and the best of the elites scored on it so far
+    vector<uint32_t> minibatch, fullSet;
+    tAgent *fullSetBest = NULL;
+    
+    // set up the evaluation farm, if requested
+    if (config.farm_local_workers > 0 || config.farm_addresses != "")
+    {
+        farm = new tFarm;
+        farm->batchSize = config.farm_batch_size;
+        farm->batchTimeout = config.farm_timeout;
+        
+        if ((config.farm_local_workers > 0 && !farm->spawnLocalWorkers(config.farm_local_workers)) ||
+            (config.farm_addresses != "" && !farm->connectWorkers(config.farm_addresses.c_str())))
+        {
+            cerr << "could not set up the evaluation farm." << endl;
+            delete farm;
+            delete game;
+            return summary;
+        }
+        
+        farm->configure(config.gridSizeX, config.gridSizeY, config.zoomingCamera, config.randomPlacement, config.noise, config.noiseAmount,
+                        config.totalSteps, config.readyActuator, config.speedBonus, config.brain_nodes, config.dataset_file,
+                        config.augment_cache, config.retina_pooling, config.retina_size);
+    }
+    
+    tCheckpoint *checkpoint = NULL;
+    
+    if (config.checkpoint_file != "")
+    {
+        checkpoint = new tCheckpoint;
+        checkpoint->fileName = config.outputPath(config.checkpoint_file);
+        signal(SIGUSR1, requestCheckpoint);
+    }
+    
+    int firstGeneration = 1;
+    
+    if (config.resume_file != "")
+    {
+        tCheckpoint resume;
+        resume.fileName = config.resume_file;
+        
+        if (!resume.load(eddAgents, fullSetBest, firstGeneration))
+        {
+            delete checkpoint;
+            delete farm;
+            delete game;
+            return summary;
+        }
+        
+        config.populationSize = (int)eddAgents.size();
+        ++firstGeneration;
+        
+        if (firstGeneration > config.totalGenerations)
+        {
+            cerr << config.resume_file << " already completed " << config.totalGenerations << " generations; use -g to continue further." << endl;
+            delete checkpoint;
+            delete farm;
+            delete game;
+            return summary;
+        }
+        
+        out << "resuming from " << config.resume_file << " at generation " << firstGeneration << " (population size " << config.populationSize << ")" << endl;
+    }
+    else if (config.seed_corpus_file == "")
+    {
+        // seed the agents
+        eddAgent = new tAgent;
+        eddAgent->setupRandomAgent(10000);
+        //eddAgent->loadAgent("startAgent.genome");
+        
+        // make mutated copies of the start genome to fill up the initial population
+        for(int i = 0; i < config.populationSize; ++i)
+        {
+            eddAgents[i] = new tAgent;
+            eddAgents[i]->inherit(eddAgent, 0.01, 1, false);
+        }
+        
+        eddAgent->nrPointingAtMe--;
+    }
+    else
+    {
+        // seed the population with the genomes of a binary genome file, in order
+        tGenomeCorpus corpus;
+        
+        if (!corpus.open(config.seed_corpus_file.c_str()) || corpus.size() == 0)
+        {
+            cerr << "no genomes to seed the population with in " << config.seed_corpus_file << endl;
+            delete checkpoint;
+            delete farm;
+            delete game;
+            return summary;
+        }
+        
+        for (int i = 0; i < config.populationSize; ++i)
+        {
+            eddAgents[i] = new tAgent;
+            
+            if (!corpus.loadAgent(i % corpus.size(), eddAgents[i]))
+            {
+                delete checkpoint;
+                delete farm;
+                delete game;
+                return summary;
+            }
+            
+            eddAgents[i]->born = 1;
+            eddAgents[i]->fitness = 0.0;
+        }
+        
+        out << "seeded the population from " << corpus.size() << " genome(s) in " << config.seed_corpus_file << endl;
+    }
+    
+	EANextGen.resize(config.populationSize);
+    
+    tMetricsLog *metrics = NULL;
+    
+    if (config.metrics_file != "")
+    {
+        tMetricsHeader header;
+        tMetricsLog::setupHeader(header);
+        header.seed = config.randomSeed;
+        header.populationSize = config.populationSize;
+        header.totalGenerations = config.totalGenerations;
+        header.perSiteMutationRate = config.perSiteMutationRate;
+        tMetricsLog::setGame(header, config.gameParameters());
+        
+        // the selection mechanism and its parameter, e.g. "roulette 4"
+        if (config.tournament)
+        {
+            snprintf(header.selection, sizeof(header.selection), "tournament %d", config.tourney_size);
+        }
+        else if (config.roulette)
+        {
+            snprintf(header.selection, sizeof(header.selection), "roulette %d", config.roulette_size);
+        }
+        else if (config.top_percent)
+        {
+            snprintf(header.selection, sizeof(header.selection), "top percent %g", config.percent_select);
+        }
+        else if (config.pure_elitism)
+        {
+            snprintf(header.selection, sizeof(header.selection), "pure elitism %d", config.elite_size);
+        }
+        else
+        {
+            snprintf(header.selection, sizeof(header.selection), "rank");
+        }
+        
+        if (config.elitism)
+        {
+            strncat(header.selection, " elitism", sizeof(header.selection) - strlen(header.selection) - 1);
+        }
+        
+        metrics = new tMetricsLog;
+        
+        if (!metrics->open(config.outputPath(config.metrics_file).c_str(), header, firstGeneration))
+        {
+            delete metrics;
+            metrics = NULL;
+        }
+    }
+    
+    tProfileData intervalProfile;
+    int intervalStart = firstGeneration;
+    
+    if (config.profile)
+    {
+        if (profileAvailable())
+        {
+            profileStart();
+            
+            // without counters (no PMU, a virtual machine...) the run is quietly profiled as usual
+            if (config.profile_hardware)
+            {
+                profileStartHardware();
+            }
+            
+            profileSnapshot(intervalProfile);
+        }
+        else
+        {
+            cerr << "edd was built without -DEDD_PROFILE; -profile has no effect." << endl;
+            config.profile = false;
+        }
+    }
+    
+	out << "setup complete" << endl;
+    out << "starting evolution" << endl;
+    
+    // main loop
+	for (int update = firstGeneration; update <= config.totalGenerations; ++update)
+    {
+        
+        
+        
+        
+        //out << update << endl;
+        //out << populationSize << endl;
+        //out << perSiteMutationRate << endl;
+        
+        
+        
+        
+        
+        PROFILE_BEGIN(phaseGeneration);
+        TRACE_BEGIN("generation");
+        tProfileData generationProfile;
+        
+        if (metrics != NULL && config.profile)
+        {
+            profileSnapshot(generationProfile);
+        }
+        
+        // reset fitnesses
+		for(int i = 0; i < config.populationSize; ++i)
+        {
+			eddAgents[i]->fitness = 0.0;
+			//eddAgents[i]->fitnesses.clear();
+		}
+        
+        // determine fitness of population
+		eddMaxFitness = 0.0;
+        double eddAvgFitness = 0.0;
+        int eddMaxIndex = 0;
+        
+        chrono::steady_clock::time_point generationStart = chrono::steady_clock::now();
+        unsigned long long farmEvaluations = (farm == NULL) ? 0 : farm->genomesSent + farm->phenotypeHits;
+        unsigned long long farmCacheHits = (farm == NULL) ? 0 : farm->phenotypeHits;
+        
+        // every agent of the generation sees the same images, a few of each digit
+        if (config.batch_per_digit > 0)
+        {
+            game->dataset->minibatch(config.batch_per_digit, config.randomSeed, update, minibatch);
+            game->batch = &minibatch;
+        }
+        
+        PROFILE_BEGIN(phaseEvaluation);
+        TRACE_BEGIN("evaluation");
+        
+        if (farm != NULL)
+        {
+            farm->evaluate(eddAgents, game);
+        }
+        else
+        {
+            for (int i = 0; i < config.populationSize; ++i)
+            {
+                game->executeGame(eddAgents[i], NULL, false, config.gridSizeX, config.gridSizeY, config.zoomingCamera, config.randomPlacement, config.noise, config.noiseAmount);
+            }
+        }
+        
+        TRACE_END("evaluation");
+        PROFILE_END(phaseEvaluation);
+        double evaluationSeconds = chrono::duration<double>(chrono::steady_clock::now() - generationStart).count();
+        PROFILE_BEGIN(phaseStatistics);
+        
+		for (int i = 0; i < config.populationSize; ++i)
+        {
+            eddAvgFitness += eddAgents[i]->classificationFitness;
+            
+            //eddAgents[i]->fitnesses.push_back(eddAgents[i]->fitness);
+            
+            if(eddAgents[i]->classificationFitness > eddMaxFitness)
+            {
+                eddMaxFitness = eddAgents[i]->classificationFitness;
+                eddMaxIndex = i;
+            }
+		}
+        
+        eddAvgFitness /= (double)config.populationSize;
+        
+        tMetricsRecord record;
+        
+        if (metrics != NULL)
+        {
+            tAccumulator fitness, genome, gates;
+            
+            for (int i = 0; i < config.populationSize; ++i)
+            {
+                fitness.add(eddAgents[i]->classificationFitness);
+                genome.add(eddAgents[i]->genome.size());
+                gates.add(eddAgents[i]->gateCount());
+            }
+            
+            memset(&record, 0, sizeof(record));
+            record.generation = update;
+            record.populationSize = config.populationSize;
+            tMetricsLog::fillRecord(record, fitness, genome, gates);
+            record.evaluationsPerSecond = (evaluationSeconds > 0.0) ? config.populationSize / evaluationSeconds : 0.0;
+            
+            if (farm != NULL)
+            {
+                record.farmEvaluations = farm->genomesSent + farm->phenotypeHits - farmEvaluations;
+                record.farmCacheHits = farm->phenotypeHits - farmCacheHits;
+            }
+        }
+        
+        summary.finalAvgFitness = eddAvgFitness;
+        summary.finalMaxFitness = eddMaxFitness;
+        summary.evaluations += config.populationSize;
+        
+        if (update == config.totalGenerations)
+        {
+            summary.fingerprint = populationFingerprint(eddAgents);
+        }
+        
+        if (eddMaxFitness > summary.bestMaxFitness || summary.bestGeneration == 0)
+        {
+            summary.bestMaxFitness = eddMaxFitness;
+            summary.bestGeneration = update;
+        }
+        
+        // make a copy of the best agent
+        if (bestEddAgent != NULL)
+        {
+            delete bestEddAgent;
+        }
+        bestEddAgent = new tAgent;
+        bestEddAgent->inherit(eddAgents[eddMaxIndex], 0.0, update, false);
+        bestEddAgent->setupPhenotype();
+        
+        // minibatch fitness is only an estimate, so every so often the elites
+        // are scored on the whole dataset, and the best of them is the run's result
+        if (config.batch_per_digit > 0 && (update % config.full_set_frequency == 0 || update == config.totalGenerations))
+        {
+            if (fullSet.empty())
+            {
+                for (uint32_t image = 0; image < game->dataset->size(); ++image)
+                {
+                    fullSet.push_back(image);
+                }
+            }
+            
+            vector<int> ranked;
+            
+            for (int i = 0; i < config.populationSize; ++i)
+            {
+                ranked.push_back(i);
+            }
+            
+            stable_sort(ranked.begin(), ranked.end(), [&](int a, int b)
+            {
+                return eddAgents[a]->classificationFitness > eddAgents[b]->classificationFitness;
+            });
+            
+            double eliteFitness = 0.0;
+            game->batch = &fullSet;
+            
+            for (int e = 0; e < min(config.full_set_elites, config.populationSize); ++e)
+            {
+                tAgent *elite = new tAgent;
+                elite->inherit(eddAgents[ranked[e]], 0.0, update, false);
+                game->executeGame(elite, NULL, false, config.gridSizeX, config.gridSizeY, config.zoomingCamera, config.randomPlacement, config.noise, config.noiseAmount);
+                eliteFitness = max(eliteFitness, elite->classificationFitness);
+                
+                if (fullSetBest == NULL || elite->classificationFitness > fullSetBest->classificationFitness)
+                {
+                    delete fullSetBest;
+                    fullSetBest = elite;
+                }
+                else
+                {
+                    delete elite;
+                }
+            }
+            
+            game->batch = &minibatch;
+            out << "gen " << update << ": full set [" << eliteFitness << " : " << fullSetBest->classificationFitness << "]" << endl;
+        }
+        
+        PROFILE_END(phaseStatistics);
+		
+        if (update % 1000 == 0)
+        {
+            out << "gen " << update << ": edd [" << eddAvgFitness << " : " << eddMaxFitness << "] [genome: " << bestEddAgent->genome.size() << "] [gates: " << bestEddAgent->hmmus.size() << "]";
+            
+            // average steps saved per digit by the ready actuator
+            if (config.readyActuator)
+            {
+                double savedSteps = 0.0;
+                
+                for (int i = 0; i < config.populationSize; ++i)
+                {
+                    savedSteps += eddAgents[i]->savedSteps;
+                }
+                
+                int trials = (config.batch_per_digit > 0) ? 10 * config.batch_per_digit : 10;
+                out << " [saved steps: " << savedSteps / ((double)trials * config.populationSize) << "]";
+            }
+            
+            out << endl;
+        }
+        
+        // display video of simulation
+        if (config.make_interval_video)
+        {
+            bool finalGeneration = (update == config.totalGenerations);
+            
+            if (update % config.make_video_frequency == 0 || finalGeneration)
+            {
+                string bestString = game->executeGame(bestEddAgent, NULL, true, config.gridSizeX, config.gridSizeY, config.zoomingCamera, config.randomPlacement, config.noise, config.noiseAmount);
+                
+                if (finalGeneration)
+                {
+                    bestString.append("X");
+                }
+            }
+        }
+        
+        
+        
+        PROFILE_BEGIN(phaseSelection);
+        TRACE_BEGIN("selection");
+        
+        if (config.tournament == true){
+            
+            //index value for most fit tAgent in the tournament round:
+            int best_index = 0;
+            
+            /*
+            sort(eddAgents.begin(), eddAgents.end(), compare);
+            
+            for (int i = 0; i < populationSize; i++){
+                out << eddAgents[i]->fitness << endl;
+            }
+            */
+            
+            // randomly shuffle the agents
+            shuffleAgents(eddAgents);
+            
+            
+            
+            
+            tAgent *best = new tAgent;
+            //best->inherit(eddAgents[0], perSiteMutationRate, update, false);
+            if (config.elitism == true){
+                int index = 0;
+                for (int i = 1; i < config.populationSize; i++){
+                    if (eddAgents[i]->fitness > eddAgents[index]->fitness){
+                        //out << i << " : " << index << " : " << eddAgents[i]->fitness << " : " << eddAgents[index]->fitness<< endl;
+                        index = i;
+                    } else {
+                        //out << index;
+                        //out << "--------------" << endl;
+                    }
+                }
+                best->inherit(eddAgents[index], config.perSiteMutationRate, update, false);
+                //out << eddAgents[index]->fitness << "!@#$@$%@%$#@%@#%!@#!@#4" << endl;
+            }
+        
+            for(int i = 0; i < config.populationSize; i += config.tourney_size)
+            {
+                
+                if ((config.populationSize - i) > config.tourney_size){
+                    
+                    best_index = 0;
+                    
+                    //determines the most fit agent in the current batch:
+                    for (int j = 0; j < config.tourney_size; j++){
+                        if (eddAgents[i + j]->fitness > eddAgents[i + best_index]->fitness){
+                            best_index = j;
+                        }
+                    }
+                    
+                    for (int j = 0; j < config.tourney_size; j++){
+                        tAgent *offspring = new tAgent;
+                        
+                        offspring->inherit(eddAgents[i + best_index], config.perSiteMutationRate, update, false);
+                        
+                        EANextGen[i + j] = offspring;
+                    }
+                     
+                } else {
+                    
+                    int tourney_remainder = config.populationSize - i;
+                    
+                    best_index = 0;
+                    
+                    //determines the most fit agent in the current batch:
+                    for (int j = 0; j < tourney_remainder; j++){
+                        if (eddAgents[i + j]->fitness > eddAgents[i + best_index]->fitness){
+                            best_index = j;
+                        }
+                    }
+                    
+                    for (int j = 0; j < tourney_remainder; j++){
+                        tAgent *offspring = new tAgent;
+                        
+                        offspring->inherit(eddAgents[i + best_index], config.perSiteMutationRate, update, false);
+                        
+                        EANextGen[i + j] = offspring;
+                    }
+                
+                
+            }
+                
+            }
+            
+            
+            
+            // shuffle the populations so there is a minimal chance of the same predator/prey combo in the next generation
+            shuffleAgents(EANextGen);
+            
+            for(int i = 0; i < config.populationSize; ++i)
+            {
+                // replace the edd agents from the previous generation
+                retireAgent(eddAgents[i]);
+                eddAgents[i] = EANextGen[i];
+            }
+            
+            
+            
+            //replaces the agent with the lowest fitness with the most fit agent from last generation:
+            if (config.elitism == true){
+                
+                sort(eddAgents.begin(), eddAgents.end(), compare);
+                
+                retireAgent(eddAgents[0]);
+                eddAgents[0] = best;
+            }
+            else
+            {
+                delete best;
+            }
+
+            
+  
+            
+        } else if (config.roulette == true){
+            
+            /*
+            sort(eddAgents.begin(), eddAgents.end(), compare);
+            
+            for (int i = 0; i < populationSize; i++){
+                out << eddAgents[i]->fitness << endl;
+            }
+             */
+            
+            float fit_count = 0.0;
+            float total_fit = 0.0;
+            bool chosen = false;
+            float random_cutoff;
+            
+            // randomly shuffle the agents
+            shuffleAgents(eddAgents);
+            
+            
+            tAgent *best = new tAgent;
+            //best->inherit(eddAgents[0], perSiteMutationRate, update, false);
+            if (config.elitism == true){
+                int index = 0;
+                for (int i = 1; i < config.populationSize; i++){
+                    if (eddAgents[i]->fitness > eddAgents[index]->fitness){
+                        //out << i << " : " << index << " : " << eddAgents[i]->fitness << " : " << eddAgents[index]->fitness<< endl;
+                        index = i;
+                    } else {
+                        //out << index;
+                        //out << "--------------" << endl;
+                    }
+                }
+                best->inherit(eddAgents[index], config.perSiteMutationRate, update, false);
+                //out << eddAgents[index]->fitness << "!@#$@$%@%$#@%@#%!@#!@#4" << endl;
+            }
+            
+            for(int i = 0; i < config.populationSize; i += config.roulette_size)
+            {
+                
+                if ((config.populationSize - (i)) > config.roulette_size){
+                    
+                    
+                    //creates the "roulette wheel":
+                    fit_count = 0.0;
+                    total_fit = 0.0;
+                    for (int j = 0; j < config.roulette_size; j++)
+                    {
+                        total_fit += eddAgents[i + j]->fitness;
+                    }
+                    
+                    random_cutoff = randDouble * total_fit;
+                    chosen = false;
+                    //determines random winner from the roulette wheel:
+                    for (int j = 0; (chosen == false) and (j < config.roulette_size); j++)
+                    {
+                        fit_count += eddAgents[i + j]->fitness;
+                        
+                        if (fit_count > random_cutoff){
+                            
+                            for (int p = 0; p < config.roulette_size; p++)
+                            {
+                                tAgent *offspring = new tAgent;
+
+                                offspring->inherit(eddAgents[i + j], config.perSiteMutationRate, update, false);
+                                
+                                EANextGen[i + p] = offspring;
+                                
+                            }
+                            
+                            chosen = true;
+                        }
+                    }
+                    
+                } else {
+                    
+                    int roulette_remainder = config.populationSize - (i);
+                    
+                    //tAgent *offspring = new tAgent;
+                    fit_count = 0.0;
+                    total_fit = 0.0;
+                    for (int j = 0; j < roulette_remainder; j++){
+                        total_fit += eddAgents[i + j]->fitness;
+                    }
+                    
+                    //uniform_real_distribution<float> dist(0, total_fit);
+                    random_cutoff = randDouble * total_fit;
+                    chosen = false;
+                    //determines random winner from the roulette wheel:
+                    for (int j = 0; (chosen == false) and (j < roulette_remainder); j++)
+                    {
+                        fit_count += eddAgents[i + j]->fitness;
+
+                        if (fit_count > random_cutoff){
+                            
+                            for (int p = 0; p < roulette_remainder; p++)
+                            {
+                                tAgent *offspring = new tAgent;
+                                
+                                offspring->inherit(eddAgents[i + j], config.perSiteMutationRate, update, false);
+                                
+                                EANextGen[i + p] = offspring;
+                            }
+
+                            chosen = true;
+                        }
+                    }
+                     
+                }
+            }
+
+            
+            
+            // shuffle the populations so there is a minimal chance of the same predator/prey combo in the next generation
+            shuffleAgents(EANextGen);
+            
+            
+            for(int i = 0; i < config.populationSize; ++i)
+            {
+                // replace the edd agents from the previous generation
+                retireAgent(eddAgents[i]);
+                
+                
+                 
+                eddAgents[i] = EANextGen[i];
+                
+            }
+            
+            //replaces the agent with the lowest fitness with the most fit agent from last generation:
+            if (config.elitism == true){
+                
+                sort(eddAgents.begin(), eddAgents.end(), compare);
+                
+                retireAgent(eddAgents[0]);
+                eddAgents[0] = best;
+            }
+            else
+            {
+                delete best;
+            }
+            
+        } else if (config.top_percent == true){
+            
+            // randomly shuffle the agents
+            shuffleAgents(eddAgents);
+            
+            tAgent *best = new tAgent;
+            if (config.elitism == true){
+                int index = 0;
+                for (int i = 1; i < config.populationSize; i++){
+                    if (eddAgents[i]->fitness > eddAgents[index]->fitness){
+                        index = i;
+                    }
+                }
+                best->inherit(eddAgents[index], config.perSiteMutationRate, update, false);
+            }
+            
+            
+            // sort the agents:
+            
+            sort(eddAgents.begin(), eddAgents.end(), compare);
+            
+            //randomly select a parent from the top percentage of agents:
+            int selection = floor(config.populationSize * config.percent_select);
+            int cutoff = randDouble * selection;
+            
+            for (int k = 0; k < config.populationSize; k++){
+                tAgent *offspring = new tAgent;
+                offspring->inherit(eddAgents[config.populationSize - 1 - cutoff], config.perSiteMutationRate, update, false);
+                EANextGen[k] = offspring;
+            }
+            
+            
+            
+            
+            // shuffle the populations so there is a minimal chance of the same predator/prey combo in the next generation
+            shuffleAgents(EANextGen);
+            
+            for(int i = 0; i < config.populationSize; ++i)
+            {
+                // replace the edd agents from the previous generation
+                retireAgent(eddAgents[i]);
+
+                eddAgents[i] = EANextGen[i];
+            }
+            
+            //replaces the agent with the lowest fitness with the most fit agent from last generation:
+            if (config.elitism == true){
+                
+                sort(eddAgents.begin(), eddAgents.end(), compare);
+                
+                retireAgent(eddAgents[0]);
+                eddAgents[0] = best;
+            }
+            else
+            {
+                delete best;
+            }
+            
+        } else if (config.pure_elitism == true){
+            
+            //for (int i = 0; i<populationSize; i++){
+            //    out << eddAgents[i]->fitness << endl;
+            //}
+            
+            
+            // sort the agents:
+            
+            sort(eddAgents.begin(), eddAgents.end(), compare);
+            
+            
+            for (int k = 0; k < config.populationSize; k++){
+                tAgent *offspring = new tAgent;
+                offspring->inherit(eddAgents[config.populationSize - 1 - (k % config.elite_size)], config.perSiteMutationRate, update, false);
+                EANextGen[k] = offspring;
+            }
+            
+            
+            for(int i = 0; i < config.populationSize; ++i)
+            {
+                // replace the edd agents from the previous generation
+                retireAgent(eddAgents[i]);
+                
+                eddAgents[i] = EANextGen[i];
+            }
+            
+            
+        }
+        
+        TRACE_END("selection");
+        PROFILE_END(phaseSelection);
+        
+        
+        
+        
+        
+        
+        PROFILE_BEGIN(phaseOutput);
+        TRACE_BEGIN("output");
+        
+        if (config.track_best_brains && update % config.track_best_brains_frequency == 0)
+        {
+            stringstream ess;
+            
+            ess << config.outputPath(config.eddGenomeFileName) << "-gen" << update;
+            
+            bestEddAgent->saveGenome(ess.str().c_str());
+        }
+        
+        if (checkpoint != NULL && (checkpoint_requests != checkpointRequestsSeen || (config.checkpoint_frequency > 0 && update % config.checkpoint_frequency == 0)))
+        {
+            checkpointRequestsSeen = checkpoint_requests;
+            checkpoint->saveInBackground(eddAgents, fullSetBest, update);
+        }
+        
+        TRACE_END("output");
+        PROFILE_END(phaseOutput);
+        PROFILE_END(phaseGeneration);
+        
+        if (metrics != NULL)
+        {
+            record.generationSeconds = chrono::duration<double>(chrono::steady_clock::now() - generationStart).count();
+            
+            if (config.profile)
+            {
+                tProfileData now, generation;
+                profileSnapshot(now);
+                profileDifference(now, generationProfile, generation);
+                tMetricsLog::fillProfile(record, generation);
+            }
+            
+            TRACE_BEGIN("write metrics");
+            metrics->write(record);
+            TRACE_END("write metrics");
+        }
+        
+        if (config.profile && config.profile_interval > 0 && update % config.profile_interval == 0)
+        {
+            tProfileData now, interval;
+            profileSnapshot(now);
+            profileDifference(now, intervalProfile, interval);
+            
+            stringstream title;
+            title << "generations " << intervalStart << "-" << update;
+            profileReport(out, interval, title.str().c_str());
+            
+            intervalProfile = now;
+            intervalStart = update + 1;
+        }
+        
+        TRACE_END("generation");
+        traceService();
+	}
+    
+    if (config.profile)
+    {
+        tProfileData total;
+        profileSnapshot(total);
+        profileReport(out, total, "whole run");
+        profileStop();
+    }
+    
+    if (checkpoint != NULL)
+    {
+        checkpoint->finish();
+    }
+	
+    // save the genome file of the best agent, by the full dataset with -batch
+    if (config.eddGenomeFileName != "")
+    {
+        tAgent *result = (fullSetBest != NULL) ? fullSetBest : bestEddAgent;
+        result->saveGenome(config.outputPath(config.eddGenomeFileName).c_str());
+    }
+    
+    // save video and quantitative stats on the best swarm agent's LOD
+    if (config.LODFileName != "")
+    {
+        vector<tAgent*> saveLOD;
+        
+        out << "building ancestor list" << endl;
+        
+        // use 2 ancestors down from current population because that ancestor is highly likely to have high fitness
+        tAgent* curAncestor = bestEddAgent;
+        
+        while (curAncestor != NULL)
+        {
+            // don't add the base ancestor
+            if (curAncestor->ancestor != NULL)
+            {
+                saveLOD.push_back(curAncestor);
+            }
+        
+            curAncestor = curAncestor->ancestor;
+        }
+        
+        reverse(saveLOD.begin(), saveLOD.end());
+        
+        FILE *LOD = fopen(config.outputPath(config.LODFileName).c_str(), "w");
+
+        fprintf(LOD, "generation,fitness\n");
+        
+        out << "analyzing ancestor list" << endl;
+        
+        // the ancestors are scored on fresh digits, not on the last minibatch
+        game->batch = NULL;
+        
+        // collect quantitative stats
+        vector<double> lodFitness;
+        game->brainSteps += analyzeLineOfDescent(saveLOD, game, config, lodFitness);
+        
+        for (int a = 0; a < saveLOD.size(); ++a)
+        {
+            fprintf(LOD, "%d,%f\n", saveLOD[a]->born, lodFitness[a]);
+        }
+        
+        // make video
+        for (vector<tAgent*>::iterator it = saveLOD.begin(); it != saveLOD.end() && config.make_LOD_video; ++it)
+        {
+            string bestString = findBestRun(game, *it, config);
+            
+            if ( (it + 1) == saveLOD.end() )
+            {
+                bestString.append("X");
+            }
+        }
+        
+        fclose(LOD);
+    }
+    
+    summary.completed = true;
+    summary.generations = config.totalGenerations;
+    summary.genomeSize = (int)bestEddAgent->genome.size();
+    summary.gates = (int)bestEddAgent->hmmus.size();
+    summary.seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    summary.brainSteps = game->brainSteps;
+    
+    // release the run's population
+    for (int i = 0; i < config.populationSize; ++i)
+    {
+        eddAgents[i]->nrPointingAtMe--;
+        if (eddAgents[i]->nrPointingAtMe == 0)
+        {
+            delete eddAgents[i];
+        }
+    }
+    
+    delete bestEddAgent;
+    delete fullSetBest;
+    delete metrics;
+    delete checkpoint;
+    delete farm;
+    delete game;
+    
+    return summary;
+}
+
+// plays the agent 100 times and returns the report of its best game
+string findBestRun(tGame *game, tAgent *eddAgent, const tConfig &config)
+{
+    string reportString = "", bestString = "";
+    double bestFitness = 0.0;
+    
+    if (config.compile_logic)
+    {
+        eddAgent->setupPhenotype();
+        eddAgent->compileLogic();
+    }
+    
+    if (config.native_directory != "")
+    {
+        compileNative(eddAgent, config.native_directory);
+    }
+    
+    for (int rep = 0; rep < 100; ++rep)
+    {
+        reportString = game->executeGame(eddAgent, NULL, true, config.gridSizeX, config.gridSizeY, config.zoomingCamera, config.randomPlacement, config.noise, config.noiseAmount);
+        
+        if (eddAgent->fitness > bestFitness)
+        {
+            bestString = reportString;
+            bestFitness = eddAgent->fitness;
+        }
+    }
+    
+    return bestString;
+}
@@ -0,0 +1,52 @@
+/*
+ * tEvolution.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson, Arend Hintze.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tEvolution_h_included_
+#define _tEvolution_h_included_
+
+#include "globalConst.h"
+#include "tAgent.h"
+#include "tGame.h"
+#include "tConfig.h"
+#include <string>
+
+using namespace std;
+
+// how a run went, for the sweep summary and -bench. evaluations counts the
+// agents evaluated, brainSteps the brain updates made in this process (farm
+// workers are not counted) and fingerprint hashes the genomes and fitnesses of
+// the final generation's population.
+struct tRunSummary
+{
+    bool completed;
+    int generations, bestGeneration, genomeSize, gates;
+    double finalAvgFitness, finalMaxFitness, bestMaxFitness, seconds;
+    unsigned long long evaluations, brainSteps, fingerprint;
+
+    tRunSummary() : completed(false), generations(0), bestGeneration(0), genomeSize(0), gates(0),
+                    finalAvgFitness(0.0), finalMaxFitness(0.0), bestMaxFitness(0.0), seconds(0.0),
+                    evaluations(0), brainSteps(0), fingerprint(0) { }
+};
+
+tRunSummary runEvolution(tConfig &config);
+string      findBestRun(tGame *game, tAgent *eddAgent, const tConfig &config);
+
+#endif
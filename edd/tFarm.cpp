@@ -0,0 +1,944 @@
+/*
+ * tFarm.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tFarm.h"
+#include "tTrace.h"
+#include "tDataset.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <map>
+#include <sstream>
+#include <iostream>
+
+// message types of the master/worker protocol. every message is a
+// (type, payload length) header followed by the payload. values are sent in
+// host byte order, so all machines of a farm must share the same endianness.
+#define     farmConfig          1
+#define     farmBatch           2
+#define     farmResults         3
+#define     farmQuit            4
+#define     farmMinibatch       5
+#define     farmReady           6
+
+struct tFarmHeader
+{
+    uint32_t type, length;
+};
+
+// one evaluated job as sent back by a worker
+struct tFarmResult
+{
+    uint32_t job;
+    double fitness, classificationFitness;
+    int32_t truePositives[10], falsePositives[10];
+    int32_t trueNegatives[10], falseNegatives[10];
+    int32_t savedSteps;
+};
+
+static bool writeAll(int socket, const void *data, size_t length)
+{
+    const char *at = (const char *)data;
+
+    while (length > 0)
+    {
+        ssize_t written = write(socket, at, length);
+
+        if (written < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (written <= 0)
+        {
+            return false;
+        }
+
+        at += written;
+        length -= written;
+    }
+
+    return true;
+}
+
+static bool readAll(int socket, void *data, size_t length)
+{
+    char *at = (char *)data;
+
+    while (length > 0)
+    {
+        ssize_t got = read(socket, at, length);
+
+        if (got < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (got <= 0)
+        {
+            return false;
+        }
+
+        at += got;
+        length -= got;
+    }
+
+    return true;
+}
+
+static bool sendMessage(int socket, uint32_t type, const vector<unsigned char> &payload)
+{
+    tFarmHeader header;
+    header.type = type;
+    header.length = (uint32_t)payload.size();
+
+    return writeAll(socket, &header, sizeof(header)) &&
+           (payload.size() == 0 || writeAll(socket, &payload[0], payload.size()));
+}
+
+static bool receiveMessage(int socket, uint32_t &type, vector<unsigned char> &payload)
+{
+    tFarmHeader header;
+
+    if (!readAll(socket, &header, sizeof(header)))
+    {
+        return false;
+    }
+
+    type = header.type;
+    payload.resize(header.length);
+
+    return header.length == 0 || readAll(socket, &payload[0], header.length);
+}
+
+template <class T> static void append(vector<unsigned char> &buffer, const T &value)
+{
+    const unsigned char *bytes = (const unsigned char *)&value;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <class T> static bool extract(const vector<unsigned char> &buffer, size_t &offset, T &value)
+{
+    if (offset + sizeof(T) > buffer.size())
+    {
+        return false;
+    }
+
+    memcpy(&value, &buffer[offset], sizeof(T));
+    offset += sizeof(T);
+
+    return true;
+}
+
+static void storeResult(tAgent *agent, const tFarmResult &result)
+{
+    agent->fitness = result.fitness;
+    agent->classificationFitness = result.classificationFitness;
+    agent->savedSteps = result.savedSteps;
+
+    // same TPR/TNR computation as tGame::executeGame
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        agent->truePositives[digit] = result.truePositives[digit];
+        agent->falsePositives[digit] = result.falsePositives[digit];
+        agent->trueNegatives[digit] = result.trueNegatives[digit];
+        agent->falseNegatives[digit] = result.falseNegatives[digit];
+
+        agent->truePositiveRate[digit] = agent->truePositives[digit] / (agent->truePositives[digit] + agent->falseNegatives[digit]);
+        agent->trueNegativeRate[digit] = agent->trueNegatives[digit] / (agent->trueNegatives[digit] + agent->falsePositives[digit]);
+    }
+}
+
+tFarm::tFarm()
+{
+    batchSize = 8;
+    pipelineDepth = 4;
+    batchTimeout = farmBatchTimeout;
+    genomesSent = 0;
+    phenotypeHits = 0;
+    jobAgents = NULL;
+    batchesDone = 0;
+    memset(&settings, 0, sizeof(settings));
+
+    // a dead worker must show up as a failed write, not kill the master
+    signal(SIGPIPE, SIG_IGN);
+}
+
+tFarm::~tFarm()
+{
+    vector<unsigned char> empty;
+
+    for (int w = 0; w < workers.size(); ++w)
+    {
+        if (workers[w].alive)
+        {
+            sendMessage(workers[w].socket, farmQuit, empty);
+            close(workers[w].socket);
+        }
+
+        if (workers[w].pid > 0)
+        {
+            waitpid(workers[w].pid, NULL, 0);
+        }
+    }
+}
+
+bool tFarm::addWorker(int socket, pid_t pid, string name)
+{
+    // a worker that stalls in the middle of a message fails the read or write
+    struct timeval timeout;
+    timeout.tv_sec = batchTimeout;
+    timeout.tv_usec = 0;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    tFarmWorker worker;
+    worker.socket = socket;
+    worker.pid = pid;
+    worker.name = name;
+    worker.alive = true;
+    workers.push_back(worker);
+
+    return true;
+}
+
+// forks the given number of workers on this machine, each connected to the
+// master through its own unix-domain socket pair
+bool tFarm::spawnLocalWorkers(int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        int sockets[2];
+
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        {
+            perror("socketpair");
+            return false;
+        }
+
+        // don't let the child inherit unflushed output
+        cout.flush();
+        fflush(stdout);
+
+        pid_t pid = fork();
+
+        if (pid < 0)
+        {
+            perror("fork");
+            close(sockets[0]);
+            close(sockets[1]);
+            return false;
+        }
+
+        if (pid == 0)
+        {
+            close(sockets[0]);
+
+            for (int w = 0; w < workers.size(); ++w)
+            {
+                if (workers[w].alive)
+                {
+                    close(workers[w].socket);
+                }
+            }
+
+            serveMaster(sockets[1]);
+            _exit(0);
+        }
+
+        close(sockets[1]);
+
+        stringstream name;
+        name << "local worker " << pid;
+        addWorker(sockets[0], pid, name.str());
+    }
+
+    return true;
+}
+
+// connects to workers started with -worker on other machines.
+// addresses is a comma-separated list of host:port pairs.
+bool tFarm::connectWorkers(const char *addresses)
+{
+    stringstream list(addresses);
+    string address;
+
+    while (getline(list, address, ','))
+    {
+        size_t colon = address.rfind(':');
+
+        if (colon == string::npos)
+        {
+            cerr << "invalid worker address (expected host:port): " << address << endl;
+            return false;
+        }
+
+        string host = address.substr(0, colon), port = address.substr(colon + 1);
+
+        struct addrinfo hints, *found = NULL;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &found) != 0)
+        {
+            cerr << "could not resolve worker " << address << endl;
+            return false;
+        }
+
+        int socket = -1;
+
+        for (struct addrinfo *at = found; at != NULL; at = at->ai_next)
+        {
+            socket = ::socket(at->ai_family, at->ai_socktype, at->ai_protocol);
+
+            if (socket >= 0 && connect(socket, at->ai_addr, at->ai_addrlen) == 0)
+            {
+                break;
+            }
+
+            if (socket >= 0)
+            {
+                close(socket);
+                socket = -1;
+            }
+        }
+
+        freeaddrinfo(found);
+
+        if (socket < 0)
+        {
+            cerr << "could not connect to worker " << address << endl;
+            return false;
+        }
+
+        // batches are already coalesced, so don't let Nagle delay them, and
+        // let the kernel notice a worker machine that went away
+        int on = 1;
+        setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        setsockopt(socket, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+
+        addWorker(socket, 0, address);
+    }
+
+    return true;
+}
+
+void tFarm::configure(int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement, bool noise, float noiseAmount,
+                      int totalSteps, bool readyActuator, double speedBonus, int brainNodes, const string &datasetFile,
+                      int augmentCache, int retinaPooling, int retinaSize)
+{
+    settings.magic = farmMagic;
+    settings.protocolVersion = farmProtocolVersion;
+    settings.size = sizeof(settings);
+    settings.gridSizeX = gridSizeX;
+    settings.gridSizeY = gridSizeY;
+    settings.zoomingCamera = zoomingCamera;
+    settings.randomPlacement = randomPlacement;
+    settings.noise = noise;
+    settings.noiseAmount = noiseAmount;
+    settings.totalSteps = totalSteps;
+    settings.readyActuator = readyActuator;
+    settings.speedBonus = speedBonus;
+    settings.brainNodes = brainNodes;
+    settings.eventDrivenBrains = eventDrivenBrains;
+    settings.fuseEventGates = fuseEventGates;
+    memset(settings.datasetFile, 0, sizeof(settings.datasetFile));
+    strncpy(settings.datasetFile, datasetFile.c_str(), sizeof(settings.datasetFile) - 1);
+    settings.augmentCache = augmentCache;
+    settings.retinaPooling = retinaPooling;
+    settings.retinaSize = retinaSize;
+
+    vector<unsigned char> payload;
+    append(payload, settings);
+
+    deque<int> unused;
+
+    for (int w = 0; w < workers.size(); ++w)
+    {
+        if (workers[w].alive && !sendMessage(workers[w].socket, farmConfig, payload))
+        {
+            killWorker(w, unused);
+        }
+    }
+
+    // a worker built from a different revision hangs up instead of
+    // acknowledging, so it never sees a batch it would misread
+    for (int w = 0; w < workers.size(); ++w)
+    {
+        uint32_t type;
+        vector<unsigned char> reply;
+
+        if (workers[w].alive && (!receiveMessage(workers[w].socket, type, reply) || type != farmReady))
+        {
+            killWorker(w, unused, "rejected the farm settings");
+        }
+    }
+}
+
+int tFarm::liveWorkers(void)
+{
+    int alive = 0;
+
+    for (int w = 0; w < workers.size(); ++w)
+    {
+        if (workers[w].alive)
+        {
+            ++alive;
+        }
+    }
+
+    return alive;
+}
+
+// drops a worker and hands the batches it still owed us back to the queue
+void tFarm::killWorker(int w, deque<int> &pendingBatches, const char *reason)
+{
+    tFarmWorker &worker = workers[w];
+
+    cerr << worker.name << " " << reason << "; reassigning " << worker.inFlight.size() << " batch(es)" << endl;
+
+    close(worker.socket);
+    worker.alive = false;
+
+    while (!worker.inFlight.empty())
+    {
+        pendingBatches.push_front(worker.inFlight.back());
+        worker.inFlight.pop_back();
+    }
+
+    worker.knownPhenotypes.clear();
+    worker.knownOrder.clear();
+
+    // a local worker may still be running, e.g. if it hung
+    if (worker.pid > 0)
+    {
+        kill(worker.pid, SIGKILL);
+        waitpid(worker.pid, NULL, 0);
+        worker.pid = 0;
+    }
+}
+
+bool tFarm::sendBatch(int w, int batch)
+{
+    tFarmWorker &worker = workers[w];
+    int first = batch * batchSize;
+    int last = min(first + batchSize, (int)jobAgents->size());
+
+    vector<unsigned char> payload;
+    append(payload, (uint32_t)batch);
+    append(payload, (uint32_t)(last - first));
+
+    for (int job = first; job < last; ++job)
+    {
+        append(payload, (uint32_t)job);
+        append(payload, jobSeeds[job]);
+        append(payload, jobHashes[job]);
+
+        if (worker.knownPhenotypes.count(jobHashes[job]) > 0)
+        {
+            append(payload, (uint32_t)0);
+            ++phenotypeHits;
+        }
+        else
+        {
+            vector<unsigned char> &genome = (*jobAgents)[job]->genome;
+            append(payload, (uint32_t)genome.size());
+            payload.insert(payload.end(), genome.begin(), genome.end());
+            ++genomesSent;
+
+            // mirror the worker's cache insertion/eviction
+            worker.knownPhenotypes.insert(jobHashes[job]);
+            worker.knownOrder.push_back(jobHashes[job]);
+
+            if (worker.knownOrder.size() > farmCacheSize)
+            {
+                worker.knownPhenotypes.erase(worker.knownOrder.front());
+                worker.knownOrder.pop_front();
+            }
+        }
+    }
+
+    // the clock runs for the oldest batch a worker owes
+    if (worker.inFlight.empty())
+    {
+        worker.deadline = chrono::steady_clock::now() + chrono::seconds(batchTimeout);
+    }
+
+    worker.inFlight.push_back(batch);
+
+    return sendMessage(worker.socket, farmBatch, payload);
+}
+
+bool tFarm::receiveResults(int w)
+{
+    tFarmWorker &worker = workers[w];
+    uint32_t type, batch, count;
+    vector<unsigned char> payload;
+    size_t offset = 0;
+
+    if (!receiveMessage(worker.socket, type, payload) || type != farmResults ||
+        !extract(payload, offset, batch) || !extract(payload, offset, count) ||
+        worker.inFlight.empty() || batch != worker.inFlight.front())
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        tFarmResult result;
+
+        if (!extract(payload, offset, result) || result.job >= jobAgents->size())
+        {
+            return false;
+        }
+
+        storeResult((*jobAgents)[result.job], result);
+    }
+
+    worker.inFlight.pop_front();
+    worker.deadline = chrono::steady_clock::now() + chrono::seconds(batchTimeout);
+    batchDone[batch] = true;
+    ++batchesDone;
+
+    return true;
+}
+
+void tFarm::evaluateLocally(int batch, tGame *game)
+{
+    int first = batch * batchSize;
+    int last = min(first + batchSize, (int)jobAgents->size());
+
+    for (int job = first; job < last; ++job)
+    {
+        eddSrand(jobSeeds[job]);
+        game->executeGame((*jobAgents)[job], NULL, false, settings.gridSizeX, settings.gridSizeY,
+                          settings.zoomingCamera, settings.randomPlacement, settings.noise, settings.noiseAmount);
+    }
+
+    batchDone[batch] = true;
+    ++batchesDone;
+}
+
+// evaluates all agents on the farm. every agent gets its own environment seed
+// drawn from the master's random stream, so the results do not depend on how
+// many workers there are, which worker ran which agent, or whether a worker
+// died along the way.
+void tFarm::evaluate(vector<tAgent*> &agents, tGame *game)
+{
+    int jobs = (int)agents.size();
+
+    // workers need the generation's minibatch before its agents
+    if (game->batch != NULL && *game->batch != sentBatch)
+    {
+        sentBatch = *game->batch;
+
+        vector<unsigned char> payload;
+        append(payload, (uint32_t)sentBatch.size());
+
+        for (size_t i = 0; i < sentBatch.size(); ++i)
+        {
+            append(payload, sentBatch[i]);
+        }
+
+        deque<int> unused;
+
+        for (int w = 0; w < workers.size(); ++w)
+        {
+            if (workers[w].alive && !sendMessage(workers[w].socket, farmMinibatch, payload))
+            {
+                killWorker(w, unused);
+            }
+        }
+    }
+
+    jobAgents = &agents;
+    jobSeeds.resize(jobs);
+    jobHashes.resize(jobs);
+
+    for (int job = 0; job < jobs; ++job)
+    {
+        agents[job]->setupPhenotype();
+        jobHashes[job] = agents[job]->phenotypeHash();
+        jobSeeds[job] = (uint32_t)eddRand();
+    }
+
+    // evaluating locally reseeds the generator, so resume from a known point
+    unsigned int resumeSeed = eddRand();
+
+    int batches = (jobs + batchSize - 1) / batchSize;
+    batchDone.assign(batches, false);
+    batchesDone = 0;
+
+    deque<int> pendingBatches;
+
+    for (int batch = 0; batch < batches; ++batch)
+    {
+        pendingBatches.push_back(batch);
+    }
+
+    while (batchesDone < batches)
+    {
+        if (liveWorkers() == 0)
+        {
+            // nobody left to farm out to, so finish the generation here
+            while (!pendingBatches.empty())
+            {
+                evaluateLocally(pendingBatches.front(), game);
+                pendingBatches.pop_front();
+            }
+
+            break;
+        }
+
+        // keep every worker's pipeline full to hide the round-trip latency
+        for (int w = 0; w < workers.size(); ++w)
+        {
+            while (workers[w].alive && workers[w].inFlight.size() < pipelineDepth && !pendingBatches.empty())
+            {
+                int batch = pendingBatches.front();
+                pendingBatches.pop_front();
+
+                if (!sendBatch(w, batch))
+                {
+                    killWorker(w, pendingBatches);
+                }
+            }
+        }
+
+        // wait no longer than the nearest deadline
+        vector<struct pollfd> polled;
+        vector<int> polledWorkers;
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        long long timeout = batchTimeout * 1000LL;
+
+        for (int w = 0; w < workers.size(); ++w)
+        {
+            if (workers[w].alive && !workers[w].inFlight.empty())
+            {
+                long long remaining = chrono::duration_cast<chrono::milliseconds>(workers[w].deadline - now).count();
+                timeout = max(0LL, min(timeout, remaining));
+
+                struct pollfd entry;
+                entry.fd = workers[w].socket;
+                entry.events = POLLIN;
+                entry.revents = 0;
+                polled.push_back(entry);
+                polledWorkers.push_back(w);
+            }
+        }
+
+        if (polled.empty())
+        {
+            continue;
+        }
+
+        TRACE_BEGIN("wait for workers");
+        int ready = poll(&polled[0], polled.size(), (int)timeout);
+        TRACE_END("wait for workers");
+        
+        if (ready < 0)
+        {
+            if (errno != EINTR)
+            {
+                perror("poll");
+            }
+
+            continue;
+        }
+
+        now = chrono::steady_clock::now();
+
+        for (int p = 0; p < polled.size(); ++p)
+        {
+            if (polled[p].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))
+            {
+                if (!receiveResults(polledWorkers[p]))
+                {
+                    killWorker(polledWorkers[p], pendingBatches);
+                }
+            }
+            else if (now >= workers[polledWorkers[p]].deadline)
+            {
+                killWorker(polledWorkers[p], pendingBatches);
+            }
+        }
+    }
+
+    eddSrand(resumeSeed);
+    jobAgents = NULL;
+}
+
+// worker side: evaluate batches until the master says goodbye or goes away
+void tFarm::serveMaster(int socket)
+{
+    tGame game;
+    tFarmSettings settings;
+    memset(&settings, 0, sizeof(settings));
+    vector<uint32_t> minibatch;
+
+    // phenotype hash -> agent carrying a genome that decodes to it
+    map<unsigned long long, tAgent*> cache;
+    deque<unsigned long long> cacheOrder;
+
+    uint32_t type;
+    vector<unsigned char> payload;
+
+    while (receiveMessage(socket, type, payload))
+    {
+        size_t offset = 0;
+
+        if (type == farmConfig)
+        {
+            if (payload.size() != sizeof(settings) || !extract(payload, offset, settings) ||
+                settings.magic != farmMagic || settings.protocolVersion != farmProtocolVersion || settings.size != sizeof(settings))
+            {
+                cerr << "the master speaks a different farm protocol (expected version " << farmProtocolVersion << "); hanging up" << endl;
+                break;
+            }
+            
+            game.totalSteps = settings.totalSteps;
+            game.readyActuator = settings.readyActuator;
+            game.speedBonus = settings.speedBonus;
+            game.retinaPooling = settings.retinaPooling;
+            game.retinaSize = settings.retinaSize;
+            
+            if (settings.retinaSize < 1 || settings.retinaSize > 5)
+            {
+                break;
+            }
+            brainNodes = settings.brainNodes;
+            eventDrivenBrains = settings.eventDrivenBrains != 0;
+            fuseEventGates = settings.fuseEventGates != 0;
+            settings.datasetFile[sizeof(settings.datasetFile) - 1] = 0;
+            game.dataset = NULL;
+            game.batch = NULL;
+            
+            if (settings.datasetFile[0] != 0 && !game.loadDataset(settings.datasetFile, settings.gridSizeX, settings.gridSizeY))
+            {
+                break;
+            }
+            
+            if (!game.setAugmentation(settings.augmentCache))
+            {
+                break;
+            }
+            
+            vector<unsigned char> empty;
+            
+            if (!sendMessage(socket, farmReady, empty))
+            {
+                break;
+            }
+        }
+        else if (type == farmMinibatch)
+        {
+            uint32_t count = 0;
+            bool valid = extract(payload, offset, count) && game.dataset != NULL;
+            minibatch.resize(valid ? count : 0);
+
+            for (uint32_t i = 0; i < count && valid; ++i)
+            {
+                valid = extract(payload, offset, minibatch[i]) && minibatch[i] < game.dataset->size();
+            }
+
+            if (!valid)
+            {
+                break;
+            }
+
+            game.batch = &minibatch;
+        }
+        else if (type == farmBatch)
+        {
+            uint32_t batch, count;
+
+            if (!extract(payload, offset, batch) || !extract(payload, offset, count))
+            {
+                break;
+            }
+
+            vector<unsigned char> results;
+            append(results, batch);
+            append(results, count);
+
+            bool valid = true;
+
+            for (uint32_t i = 0; i < count && valid; ++i)
+            {
+                uint32_t job, seed, genomeLength;
+                unsigned long long hash;
+
+                if (!extract(payload, offset, job) || !extract(payload, offset, seed) ||
+                    !extract(payload, offset, hash) || !extract(payload, offset, genomeLength) ||
+                    offset + genomeLength > payload.size())
+                {
+                    valid = false;
+                    break;
+                }
+
+                tAgent *agent = NULL;
+
+                if (genomeLength > 0)
+                {
+                    agent = new tAgent;
+                    agent->genome.assign(payload.begin() + offset, payload.begin() + offset + genomeLength);
+                    agent->born = 0;
+                    offset += genomeLength;
+
+                    // the master only resends a phenotype it thinks we
+                    // evicted; keep the copy we have rather than leaking it
+                    // and queueing its hash twice
+                    if (cache.count(hash) > 0)
+                    {
+                        delete agent;
+                        agent = cache[hash];
+                    }
+                    else
+                    {
+                        cache[hash] = agent;
+                        cacheOrder.push_back(hash);
+                    }
+
+                    if (cacheOrder.size() > farmCacheSize)
+                    {
+                        delete cache[cacheOrder.front()];
+                        cache.erase(cacheOrder.front());
+                        cacheOrder.pop_front();
+                    }
+                }
+                else if (cache.count(hash) > 0)
+                {
+                    agent = cache[hash];
+                }
+                else
+                {
+                    // the master thinks we have a phenotype we don't; bail out
+                    // and let it reassign the work
+                    valid = false;
+                    break;
+                }
+
+                eddSrand(seed);
+                game.executeGame(agent, NULL, false, settings.gridSizeX, settings.gridSizeY,
+                                 settings.zoomingCamera, settings.randomPlacement, settings.noise, settings.noiseAmount);
+
+                tFarmResult result;
+                result.job = job;
+                result.fitness = agent->fitness;
+                result.classificationFitness = agent->classificationFitness;
+                result.savedSteps = agent->savedSteps;
+
+                for (int digit = 0; digit < 10; ++digit)
+                {
+                    result.truePositives[digit] = agent->truePositives[digit];
+                    result.falsePositives[digit] = agent->falsePositives[digit];
+                    result.trueNegatives[digit] = agent->trueNegatives[digit];
+                    result.falseNegatives[digit] = agent->falseNegatives[digit];
+                }
+
+                append(results, result);
+            }
+
+            if (!valid || !sendMessage(socket, farmResults, results))
+            {
+                break;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    for (map<unsigned long long, tAgent*>::iterator it = cache.begin(); it != cache.end(); ++it)
+    {
+        delete it->second;
+    }
+
+    close(socket);
+}
+
+// -worker mode: serve one master at a time on the given TCP port
+void tFarm::listenForMasters(int port)
+{
+    int server = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (server < 0)
+    {
+        perror("socket");
+        return;
+    }
+
+    int on = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(server, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(server, 4) != 0)
+    {
+        perror("bind");
+        close(server);
+        return;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    cout << "worker listening on port " << port << endl;
+
+    while (true)
+    {
+        int client = accept(server, NULL, NULL);
+
+        if (client < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            perror("accept");
+            break;
+        }
+
+        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        setsockopt(client, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+
+        cout << "serving master" << endl;
+        serveMaster(client);
+        cout << "master disconnected" << endl;
+    }
+
+    close(server);
+}
@@ -0,0 +1,132 @@
+/*
+ * tFarm.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tFarm_h_included_
+#define _tFarm_h_included_
+
+#include "globalConst.h"
+#include "tAgent.h"
+#include "tGame.h"
+#include <sys/types.h>
+#include <stdint.h>
+#include <vector>
+#include <deque>
+#include <set>
+#include <string>
+#include <chrono>
+
+using namespace std;
+
+// number of phenotypes a worker keeps around; the master mirrors the same
+// FIFO eviction so it always knows which phenotypes it doesn't need to send
+#define     farmCacheSize       4096
+
+// default seconds a worker may take to answer its oldest outstanding batch
+// before the master gives up on it, e.g. because its machine hung or dropped
+// off the network without closing the connection (-farmtimeout)
+#define     farmBatchTimeout    60
+
+// identifies the handshake; bump farmProtocolVersion whenever tFarmSettings
+// or any message layout changes so old workers are turned away instead of
+// misreading what the master sends them
+#define     farmMagic           0x46444445
+#define     farmProtocolVersion 1
+
+// everything a worker needs to reproduce tGame::executeGame
+struct tFarmSettings
+{
+    // farmMagic, farmProtocolVersion and sizeof(tFarmSettings) of the master
+    uint32_t magic, protocolVersion, size;
+    
+    int32_t gridSizeX, gridSizeY;
+    int32_t zoomingCamera, randomPlacement, noise;
+    float noiseAmount;
+    int32_t totalSteps, readyActuator;
+    double speedBonus;
+    int32_t brainNodes;
+    int32_t eventDrivenBrains, fuseEventGates;
+    
+    // -dataset, which workers map themselves; empty for the built-in digits
+    char datasetFile[256];
+    
+    // -augment's cache size, 0 without augmentation
+    int32_t augmentCache;
+    
+    // -pool, poolNone for the plain retina
+    int32_t retinaPooling, retinaSize;
+};
+
+// master-side view of one worker process
+class tFarmWorker
+{
+public:
+    int socket;
+    pid_t pid;
+    string name;
+    bool alive;
+    deque<int> inFlight;
+    chrono::steady_clock::time_point deadline;
+    set<unsigned long long> knownPhenotypes;
+    deque<unsigned long long> knownOrder;
+};
+
+class tFarm
+{
+public:
+    vector<tFarmWorker> workers;
+    tFarmSettings settings;
+    int batchSize, pipelineDepth, batchTimeout;
+
+    // phenotypes shipped as full genomes vs. as hashes the worker already had
+    unsigned long long genomesSent, phenotypeHits;
+
+    tFarm();
+    ~tFarm();
+    bool spawnLocalWorkers(int count);
+    bool connectWorkers(const char *addresses);
+    void configure(int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement, bool noise, float noiseAmount,
+                   int totalSteps, bool readyActuator, double speedBonus, int brainNodes, const string &datasetFile,
+                   int augmentCache, int retinaPooling, int retinaSize);
+    void evaluate(vector<tAgent*> &agents, tGame *game);
+    int liveWorkers(void);
+
+    static void serveMaster(int socket);
+    static void listenForMasters(int port);
+
+private:
+    bool addWorker(int socket, pid_t pid, string name);
+    void killWorker(int w, deque<int> &pendingBatches, const char *reason = "stopped responding");
+    bool sendBatch(int w, int batch);
+    bool receiveResults(int w);
+    void evaluateLocally(int batch, tGame *game);
+
+    // state of the generation currently being evaluated
+    vector<tAgent*> *jobAgents;
+    vector<uint32_t> jobSeeds;
+    vector<unsigned long long> jobHashes;
+    int batchesDone;
+    vector<bool> batchDone;
+
+    // the minibatch the workers were last sent
+    vector<uint32_t> sentBatch;
+};
+
+#endif
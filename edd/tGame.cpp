@@ -20,23 +20,56 @@
  */
 
 #include "tGame.h"
+#include "tProfile.h"
+#include "tTrace.h"
+#include "tLogic.h"
+#include "tDataset.h"
 #include <math.h>
 #include <float.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <algorithm>
 #include <sstream>
+#include <type_traits>
 
 // simulation-specific constants
-#define totalStepsInSimulation      20
+#define maxSensors                  (111 * 111)
 
-// each sensor's (x, y) offset from the center of the camera
-map< int, vector<int> > sensorOffsetMap;
+// steps kept to find a repeated step; cycles up to one shorter are found
+#define cycleHistory                16
 
+// each sensor's (x, y) offset from the center of the camera. built once and
+// only read afterwards, so every game, on every thread, shares it.
+static int sensorOffsetX[maxSensors], sensorOffsetY[maxSensors];
 
-tGame::tGame()
+// the 5x5 digits, indexed [digit][y][x]; rows run from the bottom of the
+// digit (digitCenterY - 2) to its top (digitCenterY + 2)
+static const int digitGlyphs[10][5][5] =
+{
+    // 0
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    // 1
+    { {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0} },
+    // 2
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    // 3
+    { {0, 1, 1, 1, 0}, {0, 0, 0, 1, 0}, {0, 0, 1, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    // 4
+    { {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 0, 1, 0} },
+    // 5
+    { {0, 1, 1, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 0, 0}, {0, 1, 1, 1, 0} },
+    // 6
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 0, 0}, {0, 1, 0, 0, 0} },
+    // 7
+    { {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    // 8
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    // 9
+    { {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0} }
+};
+
+static bool setupSensorOffsets(void)
 {
-    // pre-compute the sensor offsets
     // to maintain the same order of inputs, start counting sensors from the inside.
     // e.g. for 7x7:
     
@@ -51,7 +84,7 @@ tGame::tGame()
     int offsetX = 0, offsetY = 0;
     int offsetAmount = 0;
     
-    for (int sensor = 0; sensor < 111 * 111; ++sensor)
+    for (int sensor = 0; sensor < maxSensors; ++sensor)
     {
         int root = sqrt(sensor);
         if (root % 2 == 1 && root * root == sensor)
@@ -77,47 +110,123 @@ tGame::tGame()
             --offsetY;
         }
         
-        vector<int> offsets;
-        offsets.push_back(offsetX);
-        offsets.push_back(offsetY);
-        sensorOffsetMap[sensor] = offsets;
+        sensorOffsetX[sensor] = offsetX;
+        sensorOffsetY[sensor] = offsetY;
     }
+    
+    return true;
+}
+
+
+tGame::tGame()
+{
+    brainSteps = 0;
+    stateTrace = NULL;
+    totalSteps = 20;
+    readyActuator = false;
+    speedBonus = 0.0;
+    dataset = NULL;
+    batch = NULL;
+    augmentCache = 0;
+    variantsDataset = NULL;
+    retinaPooling = poolNone;
+    retinaSize = 3;
+    
+    // pre-compute the sensor offsets the first time a game is created
+    static bool sensorOffsetsReady = setupSensorOffsets();
+    (void)sensorOffsetsReady;
 }
 
 tGame::~tGame() { }
 
-// runs the simulation for the given agent(s)
+// stands in for the report string in games without a report, so they build
+// nothing and their report code compiles away
+struct tNoReport
+{
+    template <class T> tNoReport &operator<<(const T &) { return *this; }
+    string str(void) const { return string(); }
+};
+
+// runs the simulation for the given agent(s), with brains of brainNodes nodes
 string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement, bool noise, float noiseAmount)
 {
-    stringstream reportString;
+    switch (brainNodes)
+    {
+        case 128:
+            return playGames<128>(eddAgent, dataFile, report, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
+            
+        case 256:
+            return playGames<256>(eddAgent, dataFile, report, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
+            
+        default:
+            return playGames<64>(eddAgent, dataFile, report, gridSizeX, gridSizeY, zoomingCamera, randomPlacement, noise, noiseAmount);
+    }
+}
+
+// picks the playGame instantiation for the flags, once per game
+template <int Nodes>
+string tGame::playGames(tAgent* eddAgent, FILE *dataFile, bool report, int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement, bool noise, float noiseAmount)
+{
+    typedef string (tGame::*tPlayGame)(tAgent*, FILE*, int, int, bool, float);
     
-    // grid that the digits are placed in
-    // first index is for the digit (0-9)
-    // following two indeces are the X and Y positions in that digit's grid
+    // indexed by report, zoomingCamera and randomPlacement, in that bit order
+    static const tPlayGame games[8] =
+    {
+        &tGame::playGame<Nodes, false, false, false>, &tGame::playGame<Nodes, false, false, true>,
+        &tGame::playGame<Nodes, false, true, false>, &tGame::playGame<Nodes, false, true, true>,
+        &tGame::playGame<Nodes, true, false, false>, &tGame::playGame<Nodes, true, false, true>,
+        &tGame::playGame<Nodes, true, true, false>, &tGame::playGame<Nodes, true, true, true>
+    };
+    
+    return (this->*games[report * 4 + zoomingCamera * 2 + randomPlacement])(eddAgent, dataFile, gridSizeX, gridSizeY, noise, noiseAmount);
+}
+
+// executeGame for brains of Nodes nodes, with the flags fixed at compile time
+template <int Nodes, bool Report, bool ZoomingCamera, bool RandomPlacement>
+string tGame::playGame(tAgent* eddAgent, FILE *dataFile, int gridSizeX, int gridSizeY, bool noise, float noiseAmount)
+{
+    typename conditional<Report, stringstream, tNoReport>::type reportString;
+    
+    PROFILE_COUNT(counterGames, 1);
+    TRACE_SCOPE("game");
+    
+    // one trial per digit (0-9), or with a minibatch, one per image in it
+    int trials = (batch != NULL) ? (int)batch->size() : 10;
+    
+    // grid that the current trial's digit is placed in
+    // the two indeces are the X and Y positions in the grid
     // (center - 2, center - 2) is the bottom-left corner of the digit
-    // the digit is always 5x5
-    vector< vector< vector<int> > > digitGrid;
-    digitGrid.resize(10);
+    // the built-in digits are always 5x5
+    vector< vector<int> > digitGrid(gridSizeX, vector<int>(gridSizeY, 0));
     
-    for (int digit = 0; digit < 10; ++digit)
-    {
-        digitGrid[digit].resize(gridSizeX);
-        for (int x = 0; x < gridSizeX; ++x)
-        {
-            digitGrid[digit][x].resize(gridSizeY);
-        }
-    }
+    // with a pooled retina, the pixels on below and left of every corner of
+    // the grid's cells, (x, y) at [x * (gridSizeY + 1) + y], so that the
+    // pixels on in any block are four lookups away however large it is
+    bool pooled = (retinaPooling != poolNone);
+    int cornersY = gridSizeY + 1;
+    vector<int> summedArea(pooled ? (gridSizeX + 1) * cornersY : 0, 0);
     
-    // if the digits are being randomly placed, place all 10 digits (0-9)
-    // in random spots on the grid at the beginning of every simulation
-    // otherwise, place all 10 digits (0-9) centered in the grid
-    int digitCentersX[10], digitCentersY[10];
+    // if the digits are being randomly placed, pick a random spot on the grid
+    // for every trial at the beginning of every simulation
+    // otherwise, every digit is centered in the grid
+    // with a dataset, each digit is a random image of it instead of its glyph
+    // and with augmentation, a random variant of that
+    vector<int> trialDigits(trials), digitCentersX(trials), digitCentersY(trials), digitImages(trials), digitVariants(trials);
+    int digitWidth = (dataset != NULL) ? dataset->width() : 5;
+    int digitHeight = (dataset != NULL) ? dataset->height() : 5;
     
-    for (int digit = 0; digit < 10; ++digit)
+    for (int trial = 0; trial < trials; ++trial)
     {
         int digitCenterX = (int)(gridSizeX / 2.0), digitCenterY = (int)(gridSizeY / 2.0);
         
-        if (randomPlacement)
+        if (RandomPlacement && dataset != NULL)
+        {
+            // images can nearly fill the grid, so draw from the spots that fit
+            // rather than try the whole grid
+            digitCenterX = digitWidth / 2 + eddRand() % (gridSizeX - digitWidth + 1);
+            digitCenterY = digitHeight / 2 + eddRand() % (gridSizeY - digitHeight + 1);
+        }
+        else if (RandomPlacement)
         {
             bool validPlacement = false;
             
@@ -135,20 +244,44 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
 
         }
         
-        placeDigit(digitGrid, digit, digitCenterX, digitCenterY);
+        if (batch != NULL)
+        {
+            digitImages[trial] = (*batch)[trial];
+            trialDigits[trial] = dataset->label(digitImages[trial]);
+        }
+        else if (dataset != NULL)
+        {
+            const vector<uint32_t> &images = dataset->imagesOf(trial);
+            digitImages[trial] = images[eddRand() % images.size()];
+            trialDigits[trial] = trial;
+        }
+        else
+        {
+            digitImages[trial] = -1;
+            trialDigits[trial] = trial;
+        }
         
-        digitCentersX[digit] = digitCenterX;
-        digitCentersY[digit] = digitCenterY;
+        digitVariants[trial] = (augmentCache > 0) ? eddRand() % augmentVariants : unchangedVariant;
+        digitCentersX[trial] = digitCenterX;
+        digitCentersY[trial] = digitCenterY;
     }
     
     // set up brain for EDD agent
     eddAgent->setupPhenotype();
     eddAgent->classificationFitness = 0.0;
     eddAgent->fitness = 0.0;
+    eddAgent->savedSteps = 0;
+    double speedFitness = 0.0;
     
-    // edd agent camera variables
+    // edd agent camera variables. a pooled retina never sees less than one
+    // pixel per sensor; a plain one zooms out to 9, as it always has, or
+    // further if the brain has sensor nodes in front of its actuators for it.
+    // beyond 5x5 a 64-node camera's sensors overlay the actuators
     int cameraX = gridSizeX / 2.0, cameraY = gridSizeY / 2.0;
-    int cameraSize = 3;
+    int initialCameraSize = pooled ? max(3, retinaSize) : 3;
+    int minimumCameraSize = pooled ? retinaSize : 1;
+    int maximumCameraSize = pooled ? gridSizeX : min(gridSizeX, max(9, tBrainWidth<Nodes>::largestCamera()));
+    int cameraSize = initialCameraSize;
     
     for (int digit = 0; digit < 10; ++digit)
     {
@@ -161,27 +294,75 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
     
     /*       BEGINNING OF SIMULATION LOOP       */
     
-    // test the edd agent on all 10 digits (0-9)
-    vector<int> digits;
-    for (int digit = 0; digit < 10; ++digit)
+    // a deterministic brain seeing the same digit from the same camera with the
+    // same states does the same as it did then, so once the states and camera
+    // after a step repeat those after an earlier step, the trial only cycles
+    // through the steps in between, and its end is known. the ready node is
+    // off in every step of such a cycle, or the digit would have ended. videos
+    // show every step, and noise changes what the brain sees.
+    bool detectCycles = !Report && !noise && brainIsDeterministic(eddAgent);
+    
+    struct tStepKey
+    {
+        typename tBrainWidth<Nodes>::tPacked states;
+        int cameraX, cameraY, cameraSize;
+    } history[cycleHistory];
+    
+    // test the edd agent on all 10 digits (0-9), or all images of the minibatch
+    vector<int> order;
+    for (int trial = 0; trial < trials; ++trial)
     {
-        digits.push_back(digit);
-        vector<int> digitClassifications;
+        order.push_back(trial);
     }
-    random_shuffle(digits.begin(), digits.end());
+    random_shuffle(order.begin(), order.end(), tRandomShuffle());
     
-    for (int counter = 0; counter < digits.size(); ++counter)
+    for (int counter = 0; counter < order.size(); ++counter)
     {
-        int digit = digits[counter];
+        int trial = order[counter];
+        int digit = trialDigits[trial];
+        
+        if (augmentCache > 0)
+        {
+            placeVariant(digitGrid, digit, digitImages[trial], digitVariants[trial], digitCentersX[trial], digitCentersY[trial]);
+        }
+        else if (digitImages[trial] >= 0)
+        {
+            placeImage(digitGrid, digitImages[trial], digitCentersX[trial], digitCentersY[trial]);
+        }
+        else
+        {
+            placeDigit(digitGrid, digit, digitCentersX[trial], digitCentersY[trial]);
+        }
+        
+        for (int x = 0; x < gridSizeX && pooled; ++x)
+        {
+            for (int y = 0; y < gridSizeY; ++y)
+            {
+                summedArea[(x + 1) * cornersY + y + 1] = digitGrid[x][y] + summedArea[x * cornersY + y + 1] +
+                                                         summedArea[(x + 1) * cornersY + y] - summedArea[x * cornersY + y];
+            }
+        }
         
         eddAgent->resetBrain();
         cameraX = gridSizeX / 2.0;
         cameraY = gridSizeY / 2.0;
-        cameraSize = 3;
+        cameraSize = initialCameraSize;
         
-        if (report)
+        if (Report)
         {
-            reportString << digit << "," << digitCentersX[digit] << "," << digitCentersY[digit] << "," << gridSizeX << "," << gridSizeY << "\n";
+            reportString << digit << "," << digitCentersX[trial] << "," << digitCentersY[trial] << "," << gridSizeX << "," << gridSizeY;
+            
+            if (dataset != NULL || augmentCache > 0)
+            {
+                reportString << "," << digitImages[trial];
+            }
+            
+            if (augmentCache > 0)
+            {
+                reportString << "," << digitVariants[trial];
+            }
+            
+            reportString << "\n";
             
             vector<int> inputs;
             
@@ -189,8 +370,8 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
             {
                 for (int input = 0; input < eddAgent->hmmus[hmg]->ins.size(); ++input)
                 {
-                    int number = eddAgent->hmmus[hmg]->ins[input] % 64;
-                    if (number <= 36)
+                    int number = eddAgent->hmmus[hmg]->ins[input] % Nodes;
+                    if (number < tBrainWidth<Nodes>::sensorNodes)
                     {
                         inputs.push_back(number);
                     }
@@ -200,36 +381,35 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
             sort( inputs.begin(), inputs.end() );
             inputs.erase( unique( inputs.begin(), inputs.end() ), inputs.end() );
             
-            reportString << "[" << sensorOffsetMap[inputs[0]][0] << "," << sensorOffsetMap[inputs[0]][1] << "]";
+            reportString << "[" << sensorOffsetX[inputs[0]] << "," << sensorOffsetY[inputs[0]] << "]";
             
             for (int i = 1; i < inputs.size(); ++i)
             {
-                reportString << ",[" << sensorOffsetMap[inputs[i]][0] << "," << sensorOffsetMap[inputs[i]][1] << "]";
+                reportString << ",[" << sensorOffsetX[inputs[i]] << "," << sensorOffsetY[inputs[i]] << "]";
             }
             
             reportString << "\n";
         }
         
-        for (int step = 0; step < totalStepsInSimulation; ++step)
+        PROFILE_BEGIN(phaseSteps);
+        int stepsTaken = totalSteps;
+        
+        for (int step = 0; step < totalSteps; ++step)
         {
             
             /*       CREATE THE REPORT STRING FOR THE VIDEO       */
-            if (report)
+            if (Report)
             {
                 reportString << cameraX << "," << cameraY << "," << cameraSize << "\n";
             }
             /*       END OF REPORT STRING CREATION       */
             
             
-            /*       SAVE DATA FOR THE LOD FILE       */
-            if (dataFile != NULL)
-            {
-                
-            }
-            /*       END OF DATA GATHERING       */
+            PROFILE_BEGIN(phaseSensing);
             
-            // clear all sensors
-            for (int sensor = 0; sensor < pow(min(gridSizeX, gridSizeY), 2.0); ++sensor)
+            // clear all sensors. grids with more cells than the brain has nodes
+            // (wider than 8 with 64 nodes) only ever sense the first Nodes cells
+            for (int sensor = 0; sensor < min(pow(min(gridSizeX, gridSizeY), 2.0), (double)Nodes); ++sensor)
             {
                 eddAgent->states[sensor] = 0;
             }
@@ -254,23 +434,56 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
             // 48 9  10 11 12 13 32
             // 25 26 27 28 29 30 31
             
-            for (int sensor = 0; sensor < cameraSize * cameraSize; ++sensor)
+            // a pooled retina splits the camera's view into retinaSize x retinaSize
+            // blocks, numbered as the sensors of a camera of that size. pixels
+            // off the grid are off.
+            int viewLeft = cameraX - cameraSize / 2, viewBottom = cameraY - cameraSize / 2;
+            
+            for (int sensor = 0; sensor < min(retinaSize * retinaSize, Nodes) && pooled; ++sensor)
+            {
+                int column = sensorOffsetX[sensor] + retinaSize / 2, row = sensorOffsetY[sensor] + retinaSize / 2;
+                int left = viewLeft + column * cameraSize / retinaSize;
+                int right = viewLeft + (column + 1) * cameraSize / retinaSize;
+                int bottom = viewBottom + row * cameraSize / retinaSize;
+                int top = viewBottom + (row + 1) * cameraSize / retinaSize;
+                int area = (right - left) * (top - bottom);
+                
+                left = max(0, min(left, gridSizeX));
+                right = max(0, min(right, gridSizeX));
+                bottom = max(0, min(bottom, gridSizeY));
+                top = max(0, min(top, gridSizeY));
+                
+                int on = summedArea[right * cornersY + top] - summedArea[left * cornersY + top] -
+                         summedArea[right * cornersY + bottom] + summedArea[left * cornersY + bottom];
+                
+                eddAgent->states[sensor] = (retinaPooling == poolAny) ? (on > 0) : (on * 2 > area);
+            }
+            
+            for (int sensor = 0; sensor < min(cameraSize * cameraSize, Nodes) && !pooled; ++sensor)
             {
-                int sensorX = cameraX + sensorOffsetMap[sensor][0];
-                int sensorY = cameraY + sensorOffsetMap[sensor][1];
+                int sensorX = cameraX + sensorOffsetX[sensor];
+                int sensorY = cameraY + sensorOffsetY[sensor];
                 
                 if (sensorX >= 0 && sensorX < gridSizeX && sensorY >= 0 && sensorY < gridSizeY)
                 {
-                    if (digitGrid[digit][sensorX][sensorY] == 1)
+                    if (digitGrid[sensorX][sensorY] == 1)
                     {
                         eddAgent->states[sensor] = 1;
                     }
                 }
             }
             
+            PROFILE_END(phaseSensing);
+            
             // activate the edd agent's brain
 
             eddAgent->updateStates();
+            ++brainSteps;
+            
+            if (stateTrace != NULL)
+            {
+                stateTrace->insert(stateTrace->end(), eddAgent->states, eddAgent->states + Nodes);
+            }
             
             
             // get edd agent's action
@@ -281,37 +494,98 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
             //      zoom out: 1
             //      classify (0-9): 10
             //      veto bits (0-9): 10
-            //      TODO: "I'm ready" bit: 1
+            //      "I'm ready" bit: 1 (with -ready)
             
-            int moveUp = eddAgent->states[(maxNodes - 1)] & 1;
-            int moveDown = eddAgent->states[(maxNodes - 2)] & 1;
-            int moveLeft = eddAgent->states[(maxNodes - 3)] & 1;
-            int moveRight = eddAgent->states[(maxNodes - 4)] & 1;
-            int zoomIn = eddAgent->states[(maxNodes - 5)] & 1;
-            int zoomOut = eddAgent->states[(maxNodes - 6)] & 1;
+            if (readyActuator && (eddAgent->states[Nodes - 27] & 1))
+            {
+                stepsTaken = step + 1;
+                break;
+            }
+            
+            int moveUp = eddAgent->states[(Nodes - 1)] & 1;
+            int moveDown = eddAgent->states[(Nodes - 2)] & 1;
+            int moveLeft = eddAgent->states[(Nodes - 3)] & 1;
+            int moveRight = eddAgent->states[(Nodes - 4)] & 1;
+            int zoomIn = eddAgent->states[(Nodes - 5)] & 1;
+            int zoomOut = eddAgent->states[(Nodes - 6)] & 1;
             
             // edd agent can move the camera
             // possible for up/down and left/right actuators to cancel each other out
-            if (zoomingCamera && moveUp) cameraY += 1;
-            if (zoomingCamera && moveDown) cameraY -= 1;
-            if (zoomingCamera && moveRight) cameraX += 1;
-            if (zoomingCamera && moveLeft) cameraX -= 1;
+            if (ZoomingCamera && moveUp) cameraY += 1;
+            if (ZoomingCamera && moveDown) cameraY -= 1;
+            if (ZoomingCamera && moveRight) cameraX += 1;
+            if (ZoomingCamera && moveLeft) cameraX -= 1;
             
             // zoom the camera in and out
-            // minimum camera size = 1
-            if (zoomingCamera && zoomIn && cameraSize > 1)
+            // minimum camera size = 1, or a pixel per sensor of a pooled retina
+            if (ZoomingCamera && zoomIn && cameraSize > minimumCameraSize)
             {
                 cameraSize -= 2;
             }
             
-            // maximum camera size is limited by size of digit grid
-            if (zoomingCamera && zoomOut && cameraSize + 2 <= gridSizeX && cameraSize + 2 <= 9)
+            // maximum camera size is limited by size of digit grid, and to 9
+            // unless the retina is pooled
+            if (ZoomingCamera && zoomOut && cameraSize + 2 <= maximumCameraSize)
             {
                 cameraSize += 2;
             }
+            
+            if (detectCycles)
+            {
+                tStepKey &key = history[step % cycleHistory];
+                tBrainWidth<Nodes>::pack(eddAgent->states, key.states);
+                key.cameraX = cameraX;
+                key.cameraY = cameraY;
+                key.cameraSize = cameraSize;
+                
+                int period = 0;
+                
+                for (int back = 1; back <= min(step, cycleHistory - 1) && period == 0; ++back)
+                {
+                    const tStepKey &earlier = history[(step - back) % cycleHistory];
+                    
+                    if (earlier.states == key.states && earlier.cameraX == cameraX && earlier.cameraY == cameraY &&
+                        earlier.cameraSize == cameraSize)
+                    {
+                        period = back;
+                    }
+                }
+                
+                if (period > 0)
+                {
+                    // every later step repeats the one period steps before it
+                    int first = step - period;
+                    
+                    if (stateTrace != NULL)
+                    {
+                        unsigned char states[Nodes];
+                        
+                        for (int later = step + 1; later < totalSteps; ++later)
+                        {
+                            tBrainWidth<Nodes>::unpack(history[(first + (later - first) % period) % cycleHistory].states, states);
+                            stateTrace->insert(stateTrace->end(), states, states + Nodes);
+                        }
+                    }
+                    
+                    int lastStep = first + (totalSteps - 1 - first) % period;
+                    tBrainWidth<Nodes>::unpack(history[lastStep % cycleHistory].states, eddAgent->states);
+                    
+                    // and the skipped steps' gates would each have drawn a random number
+                    long long skippedDraws = (long long)(totalSteps - 1 - step) * eddAgent->hmmus.size();
+                    
+                    for (long long draw = 0; draw < skippedDraws; ++draw)
+                    {
+                        eddRand();
+                    }
+                    
+                    break;
+                }
+            }
         }
+        PROFILE_END(phaseSteps);
+        eddAgent->savedSteps += totalSteps - stepsTaken;
         
-        if (report)
+        if (Report)
         {
             reportString << "X\n";
         }
@@ -320,14 +594,14 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
         int classifyDigit[10];
         for (int i = 0; i < 10; ++i)
         {
-            classifyDigit[i] = eddAgent->states[(maxNodes - 7 - i)] & 1;
+            classifyDigit[i] = eddAgent->states[(Nodes - 7 - i)] & 1;
             //cout <<classifyDigit[i] << endl;
         }
         
         int vetoBits[10];
         for (int i = 0; i < 10; ++i)
         {
-            vetoBits[i] = eddAgent->states[(maxNodes - 17 - i)] & 1;
+            vetoBits[i] = eddAgent->states[(Nodes - 17 - i)] & 1;
         }
         
         // check accuracy of edd agent classifications
@@ -374,6 +648,7 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
         if (numDigitsGuessed > 0.0)
         {
             eddAgent->classificationFitness += score / numDigitsGuessed;
+            speedFitness += speedBonus * (score / numDigitsGuessed) * (totalSteps - stepsTaken) / totalSteps;
         }
     }
     
@@ -391,8 +666,8 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
     //cout << *eddAgent->truePositiveRate << " : " << *eddAgent->trueNegativeRate << endl;
     
     // compute overall fitness
-    eddAgent->fitness = eddAgent->classificationFitness / 10.0;
-    eddAgent->classificationFitness = eddAgent->classificationFitness / 10.0;
+    eddAgent->fitness = (eddAgent->classificationFitness + speedFitness) / trials;
+    eddAgent->classificationFitness = eddAgent->classificationFitness / trials;
     
     // don't allow fitness to be 0 nor negative
     if (eddAgent->fitness <= 0.0)
@@ -412,412 +687,145 @@ string tGame::executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gri
     return reportString.str();
 }
 
+// draws the digits from the dataset in the given file from now on. false if it
+// is not a dataset or its images do not fit in the grid.
+bool tGame::loadDataset(const char *filename, int gridSizeX, int gridSizeY)
+{
+    dataset = tDataset::shared(filename);
+    
+    if (dataset != NULL && (dataset->width() > gridSizeX || dataset->height() > gridSizeY))
+    {
+        cerr << "the " << dataset->width() << "x" << dataset->height() << " images in " << filename
+             << " do not fit in the grid; use -gs " << dataset->width() << " " << dataset->height() << " or larger." << endl;
+        dataset = NULL;
+        return false;
+    }
+    
+    return dataset != NULL;
+}
+
+// place the given dataset image on the digitGrid, centered at
+// (digitCenterX, digitCenterY). the grid's y runs up, the image's rows down.
+void tGame::placeImage(vector< vector<int> > &digitGrid, int image, int digitCenterX, int digitCenterY)
+{
+    int left = digitCenterX - dataset->width() / 2;
+    int bottom = digitCenterY - dataset->height() / 2;
+    
+    for (int x = 0; x < digitGrid.size(); ++x)
+    {
+        fill(digitGrid[x].begin(), digitGrid[x].end(), 0);
+    }
+    
+    for (int y = 0; y < dataset->height(); ++y)
+    {
+        for (int x = 0; x < dataset->width(); ++x)
+        {
+            digitGrid[left + x][bottom + dataset->height() - 1 - y] = dataset->pixel(image, x, y);
+        }
+    }
+}
+
+// shows a random variant of every digit from now on, keeping cacheSize of
+// them rendered. false if the digits are too wide to augment.
+bool tGame::setAugmentation(int cacheSize)
+{
+    augmentCache = cacheSize;
+    
+    if (cacheSize > 0 && dataset != NULL && dataset->width() > maxAugmentWidth)
+    {
+        cerr << "-augment works on digits at most " << maxAugmentWidth << " pixels wide." << endl;
+        augmentCache = 0;
+        return false;
+    }
+    
+    return true;
+}
+
+// the rows of a variant of a digit's glyph, or of a dataset image if image is
+// not negative, rendered the first time it is needed. a trial only looks it up.
+const uint64_t *tGame::digitVariant(int digit, int image, int variant)
+{
+    int width = (dataset != NULL) ? dataset->width() : 5;
+    int height = (dataset != NULL) ? dataset->height() : 5;
+    
+    if (variants.capacity() != augmentCache || variantsDataset != dataset)
+    {
+        variants.reset(augmentCache, height);
+        variantsDataset = dataset;
+    }
+    
+    uint64_t key = (uint64_t)((image >= 0) ? 10 + image : digit) * augmentVariants + variant;
+    const uint64_t *rows = variants.find(key);
+    
+    if (rows != NULL)
+    {
+        return rows;
+    }
+    
+    sourceRows.assign(height, 0);
+    
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            // glyph rows run up, image and variant rows down
+            bool on = (image >= 0) ? dataset->pixel(image, x, y) : digitGlyphs[digit][4 - y][x];
+            sourceRows[y] |= (uint64_t)on << x;
+        }
+    }
+    
+    uint64_t *rendered = variants.insert(key);
+    augmentRows(&sourceRows[0], width, height, variant, rendered);
+    return rendered;
+}
+
+// place a variant of the given digit, or of the given dataset image if image
+// is not negative, on the digitGrid centered at (digitCenterX, digitCenterY)
+void tGame::placeVariant(vector< vector<int> > &digitGrid, int digit, int image, int variant, int digitCenterX, int digitCenterY)
+{
+    int width = (dataset != NULL) ? dataset->width() : 5;
+    int height = (dataset != NULL) ? dataset->height() : 5;
+    int left = digitCenterX - width / 2;
+    int bottom = digitCenterY - height / 2;
+    const uint64_t *rows = digitVariant(digit, image, variant);
+    
+    for (int x = 0; x < digitGrid.size(); ++x)
+    {
+        fill(digitGrid[x].begin(), digitGrid[x].end(), 0);
+    }
+    
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            digitGrid[left + x][bottom + height - 1 - y] = (rows[y] >> x) & 1;
+        }
+    }
+}
+
 // place the given digit on the digitGrid at the given point (digitCenterX, digitCenterY)
-void tGame::placeDigit(vector< vector< vector<int> > > &digitGrid, int digit, int digitCenterX, int digitCenterY)
+void tGame::placeDigit(vector< vector<int> > &digitGrid, int digit, int digitCenterX, int digitCenterY)
 {
-    for (int i = 0; i < digitGrid[digit].size(); ++i)
+    for (int i = 0; i < digitGrid.size(); ++i)
     {
-        for (int j = 0; j < digitGrid[digit][i].size(); ++j)
+        for (int j = 0; j < digitGrid[i].size(); ++j)
         {
-            digitGrid[digit][i][j] = 0;
+            digitGrid[i][j] = 0;
         }
     }
     
-    switch (digit)
+    if (digit < 0 || digit > 9)
     {
-        case 0:
-            // ~ 0 ~
-            
-            // 0 1 1 1 0
-            // 0 1 0 1 0
-            // 0 1 0 1 0
-            // 0 1 0 1 0
-            // 0 1 1 1 0
-            digitGrid[0][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[0][digitCenterX - 1][digitCenterY - 2] = 1;
-            digitGrid[0][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[0][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[0][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[0][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[0][digitCenterX - 1][digitCenterY - 1] = 1;
-            digitGrid[0][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[0][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[0][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[0][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[0][digitCenterX - 1][digitCenterY] = 1;
-            digitGrid[0][digitCenterX][digitCenterY] = 0;
-            digitGrid[0][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[0][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[0][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[0][digitCenterX - 1][digitCenterY + 1] = 1;
-            digitGrid[0][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[0][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[0][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[0][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[0][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[0][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[0][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[0][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 1:
-            // ~ 1 ~
-            
-            // 0 0 1 0 0
-            // 0 0 1 0 0
-            // 0 0 1 0 0
-            // 0 0 1 0 0
-            // 0 0 1 0 0
-            digitGrid[1][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[1][digitCenterX - 1][digitCenterY - 2] = 0;
-            digitGrid[1][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[1][digitCenterX + 1][digitCenterY - 2] = 0;
-            digitGrid[1][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[1][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[1][digitCenterX - 1][digitCenterY - 1] = 0;
-            digitGrid[1][digitCenterX][digitCenterY - 1] = 1;
-            digitGrid[1][digitCenterX + 1][digitCenterY - 1] = 0;
-            digitGrid[1][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[1][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[1][digitCenterX - 1][digitCenterY] = 0;
-            digitGrid[1][digitCenterX][digitCenterY] = 1;
-            digitGrid[1][digitCenterX + 1][digitCenterY] = 0;
-            digitGrid[1][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[1][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[1][digitCenterX - 1][digitCenterY + 1] = 0;
-            digitGrid[1][digitCenterX][digitCenterY + 1] = 1;
-            digitGrid[1][digitCenterX + 1][digitCenterY + 1] = 0;
-            digitGrid[1][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[1][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[1][digitCenterX - 1][digitCenterY + 2] = 0;
-            digitGrid[1][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[1][digitCenterX + 1][digitCenterY + 2] = 0;
-            digitGrid[1][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 2:
-            // ~ 2 ~
-            
-            // 0 1 1 1 0
-            // 0 0 0 1 0
-            // 0 0 1 0 0
-            // 0 1 0 0 0
-            // 0 1 1 1 0
-            digitGrid[2][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[2][digitCenterX - 1][digitCenterY - 2] = 1;
-            digitGrid[2][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[2][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[2][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[2][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[2][digitCenterX - 1][digitCenterY - 1] = 1;
-            digitGrid[2][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[2][digitCenterX + 1][digitCenterY - 1] = 0;
-            digitGrid[2][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[2][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[2][digitCenterX - 1][digitCenterY] = 0;
-            digitGrid[2][digitCenterX][digitCenterY] = 1;
-            digitGrid[2][digitCenterX + 1][digitCenterY] = 0;
-            digitGrid[2][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[2][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[2][digitCenterX - 1][digitCenterY + 1] = 0;
-            digitGrid[2][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[2][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[2][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[2][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[2][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[2][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[2][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[2][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 3:
-            // ~ 3 ~
-            
-            // 0 1 1 1 0
-            // 0 0 0 1 0
-            // 0 0 1 1 0
-            // 0 0 0 1 0
-            // 0 1 1 1 0
-            digitGrid[3][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[3][digitCenterX - 1][digitCenterY - 2] = 1;
-            digitGrid[3][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[3][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[3][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[3][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[3][digitCenterX - 1][digitCenterY - 1] = 0;
-            digitGrid[3][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[3][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[3][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[3][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[3][digitCenterX - 1][digitCenterY] = 0;
-            digitGrid[3][digitCenterX][digitCenterY] = 1;
-            digitGrid[3][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[3][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[3][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[3][digitCenterX - 1][digitCenterY + 1] = 0;
-            digitGrid[3][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[3][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[3][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[3][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[3][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[3][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[3][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[3][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 4:
-            // ~ 4 ~
-            
-            // 0 1 0 1 0
-            // 0 1 0 1 0
-            // 0 1 1 1 0
-            // 0 0 0 1 0
-            // 0 0 0 1 0
-            digitGrid[4][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[4][digitCenterX - 1][digitCenterY - 2] = 0;
-            digitGrid[4][digitCenterX][digitCenterY - 2] = 0;
-            digitGrid[4][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[4][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[4][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[4][digitCenterX - 1][digitCenterY - 1] = 0;
-            digitGrid[4][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[4][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[4][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[4][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[4][digitCenterX - 1][digitCenterY] = 1;
-            digitGrid[4][digitCenterX][digitCenterY] = 1;
-            digitGrid[4][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[4][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[4][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[4][digitCenterX - 1][digitCenterY + 1] = 1;
-            digitGrid[4][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[4][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[4][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[4][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[4][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[4][digitCenterX][digitCenterY + 2] = 0;
-            digitGrid[4][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[4][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 5:
-            // ~ 5 ~
-            
-            // 0 1 1 1 0
-            // 0 1 0 0 0
-            // 0 1 1 1 0
-            // 0 0 0 1 0
-            // 0 1 1 1 0
-            digitGrid[5][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[5][digitCenterX - 1][digitCenterY - 2] = 1;
-            digitGrid[5][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[5][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[5][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[5][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[5][digitCenterX - 1][digitCenterY - 1] = 0;
-            digitGrid[5][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[5][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[5][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[5][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[5][digitCenterX - 1][digitCenterY] = 1;
-            digitGrid[5][digitCenterX][digitCenterY] = 1;
-            digitGrid[5][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[5][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[5][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[5][digitCenterX - 1][digitCenterY + 1] = 1;
-            digitGrid[5][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[5][digitCenterX + 1][digitCenterY + 1] = 0;
-            digitGrid[5][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[5][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[5][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[5][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[5][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[5][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 6:
-            // ~ 6 ~
-            
-            // 0 1 0 0 0
-            // 0 1 0 0 0
-            // 0 1 1 1 0
-            // 0 1 0 1 0
-            // 0 1 1 1 0
-            digitGrid[6][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[6][digitCenterX - 1][digitCenterY - 2] = 1;
-            digitGrid[6][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[6][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[6][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[6][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[6][digitCenterX - 1][digitCenterY - 1] = 1;
-            digitGrid[6][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[6][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[6][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[6][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[6][digitCenterX - 1][digitCenterY] = 1;
-            digitGrid[6][digitCenterX][digitCenterY] = 1;
-            digitGrid[6][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[6][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[6][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[6][digitCenterX - 1][digitCenterY + 1] = 1;
-            digitGrid[6][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[6][digitCenterX + 1][digitCenterY + 1] = 0;
-            digitGrid[6][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[6][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[6][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[6][digitCenterX][digitCenterY + 2] = 0;
-            digitGrid[6][digitCenterX + 1][digitCenterY + 2] = 0;
-            digitGrid[6][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 7:
-            // ~ 7 ~
-            
-            // 0 1 1 1 0
-            // 0 0 0 1 0
-            // 0 0 0 1 0
-            // 0 0 0 1 0
-            // 0 0 0 1 0
-            digitGrid[7][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[7][digitCenterX - 1][digitCenterY - 2] = 0;
-            digitGrid[7][digitCenterX][digitCenterY - 2] = 0;
-            digitGrid[7][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[7][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[7][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[7][digitCenterX - 1][digitCenterY - 1] = 0;
-            digitGrid[7][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[7][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[7][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[7][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[7][digitCenterX - 1][digitCenterY] = 0;
-            digitGrid[7][digitCenterX][digitCenterY] = 0;
-            digitGrid[7][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[7][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[7][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[7][digitCenterX - 1][digitCenterY + 1] = 0;
-            digitGrid[7][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[7][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[7][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[7][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[7][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[7][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[7][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[7][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 8:
-            // ~ 8 ~
-            
-            // 0 1 1 1 0
-            // 0 1 0 1 0
-            // 0 1 1 1 0
-            // 0 1 0 1 0
-            // 0 1 1 1 0
-            digitGrid[8][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[8][digitCenterX - 1][digitCenterY - 2] = 1;
-            digitGrid[8][digitCenterX][digitCenterY - 2] = 1;
-            digitGrid[8][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[8][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[8][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[8][digitCenterX - 1][digitCenterY - 1] = 1;
-            digitGrid[8][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[8][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[8][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[8][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[8][digitCenterX - 1][digitCenterY] = 1;
-            digitGrid[8][digitCenterX][digitCenterY] = 1;
-            digitGrid[8][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[8][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[8][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[8][digitCenterX - 1][digitCenterY + 1] = 1;
-            digitGrid[8][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[8][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[8][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[8][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[8][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[8][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[8][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[8][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        case 9:
-            // ~ 9 ~
-            
-            // 0 1 1 1 0
-            // 0 1 0 1 0
-            // 0 1 1 1 0
-            // 0 0 0 1 0
-            // 0 0 0 1 0
-            digitGrid[9][digitCenterX - 2][digitCenterY - 2] = 0;
-            digitGrid[9][digitCenterX - 1][digitCenterY - 2] = 0;
-            digitGrid[9][digitCenterX][digitCenterY - 2] = 0;
-            digitGrid[9][digitCenterX + 1][digitCenterY - 2] = 1;
-            digitGrid[9][digitCenterX + 2][digitCenterY - 2] = 0;
-            
-            digitGrid[9][digitCenterX - 2][digitCenterY - 1] = 0;
-            digitGrid[9][digitCenterX - 1][digitCenterY - 1] = 0;
-            digitGrid[9][digitCenterX][digitCenterY - 1] = 0;
-            digitGrid[9][digitCenterX + 1][digitCenterY - 1] = 1;
-            digitGrid[9][digitCenterX + 2][digitCenterY - 1] = 0;
-            
-            digitGrid[9][digitCenterX - 2][digitCenterY] = 0;
-            digitGrid[9][digitCenterX - 1][digitCenterY] = 1;
-            digitGrid[9][digitCenterX][digitCenterY] = 1;
-            digitGrid[9][digitCenterX + 1][digitCenterY] = 1;
-            digitGrid[9][digitCenterX + 2][digitCenterY] = 0;
-            
-            digitGrid[9][digitCenterX - 2][digitCenterY + 1] = 0;
-            digitGrid[9][digitCenterX - 1][digitCenterY + 1] = 1;
-            digitGrid[9][digitCenterX][digitCenterY + 1] = 0;
-            digitGrid[9][digitCenterX + 1][digitCenterY + 1] = 1;
-            digitGrid[9][digitCenterX + 2][digitCenterY + 1] = 0;
-            
-            digitGrid[9][digitCenterX - 2][digitCenterY + 2] = 0;
-            digitGrid[9][digitCenterX - 1][digitCenterY + 2] = 1;
-            digitGrid[9][digitCenterX][digitCenterY + 2] = 1;
-            digitGrid[9][digitCenterX + 1][digitCenterY + 2] = 1;
-            digitGrid[9][digitCenterX + 2][digitCenterY + 2] = 0;
-            break;
-            
-        default:
-            cerr << "invalid digit to place: " << digit << endl;
-            break;
+        cerr << "invalid digit to place: " << digit << endl;
+        return;
+    }
+    
+    for (int y = 0; y < 5; ++y)
+    {
+        for (int x = 0; x < 5; ++x)
+        {
+            digitGrid[digitCenterX - 2 + x][digitCenterY - 2 + y] = digitGlyphs[digit][y][x];
+        }
     }
 }
 
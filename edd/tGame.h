@@ -24,6 +24,7 @@
 
 #include "globalConst.h"
 #include "tAgent.h"
+#include "tAugment.h"
 #include <vector>
 #include <map>
 #include <set>
@@ -31,15 +32,66 @@
 
 using namespace std;
 
+class tDataset;
+
+// how the sensors of a pooled retina (-pool) read the pixels they cover
+#define     poolNone            0
+#define     poolAny             1
+#define     poolMajority        2
+
 class tGame
 {
 public:
+    // brain updates made by this game's executeGame calls
+    unsigned long long brainSteps;
+    
+    // if set, executeGame appends the brain's states to it after every step
+    vector<unsigned char> *stateTrace;
+    
+    // brain steps per digit (-steps), whether the 27th node from the end ends
+    // a digit once the brain switches it on (-ready), and the fitness a correct classification
+    // earns for the share of the steps it saved (-speed)
+    int totalSteps;
+    bool readyActuator;
+    double speedBonus;
+    
+    // if set, digits are random images from it instead of the glyphs (-dataset)
+    const tDataset *dataset;
+    
+    // if set, the dataset images to show instead of one of each digit, the
+    // same for every game of a generation (-batch)
+    const vector<uint32_t> *batch;
+    
+    // with augmentation (-augment), the number of variants kept rendered;
+    // each trial then shows a random variant of its digit. 0 for none
+    int augmentCache;
+    
+    // with a pooled retina (-pool), retinaSize x retinaSize sensors whatever
+    // the zoom, each on if any (poolAny) or most (poolMajority) of the block
+    // of the camera's view it covers is on
+    int retinaPooling, retinaSize;
+    
     string executeGame(tAgent* eddAgent, FILE *dataFile, bool report, int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement, bool noise, float noiseAmount);
     tGame();
+    bool loadDataset(const char *filename, int gridSizeX, int gridSizeY);
+    bool setAugmentation(int cacheSize);
     ~tGame();
-    void placeDigit(vector< vector< vector<int> > > &digitGrid, int digit, int digitCenterX, int digitCenterY);
+    void placeDigit(vector< vector<int> > &digitGrid, int digit, int digitCenterX, int digitCenterY);
+    void placeImage(vector< vector<int> > &digitGrid, int image, int digitCenterX, int digitCenterY);
+    void placeVariant(vector< vector<int> > &digitGrid, int digit, int image, int variant, int digitCenterX, int digitCenterY);
     double sum(vector<double> values);
     double average(vector<double> values);
     double variance(vector<double> values);
+
+private:
+    tVariantCache variants;
+    const tDataset *variantsDataset;
+    vector<uint64_t> sourceRows;
+    
+    const uint64_t *digitVariant(int digit, int image, int variant);
+    template <int Nodes>
+    string playGames(tAgent* eddAgent, FILE *dataFile, bool report, int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement, bool noise, float noiseAmount);
+    template <int Nodes, bool Report, bool ZoomingCamera, bool RandomPlacement>
+    string playGame(tAgent* eddAgent, FILE *dataFile, int gridSizeX, int gridSizeY, bool noise, float noiseAmount);
 };
 #endif
@@ -0,0 +1,262 @@
+/*
+ * tGenomeFile.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tGenomeFile.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <iostream>
+
+static const char genomeFileMagic[8] = { 'E', 'D', 'D', 'G', 'E', 'N', 'O', 'M' };
+
+tGenomeCorpus::tGenomeCorpus()
+{
+    base = NULL;
+    mappedSize = 0;
+    header = NULL;
+    index = NULL;
+}
+
+tGenomeCorpus::~tGenomeCorpus()
+{
+    close();
+}
+
+// FNV-1a, 32 bit
+uint32_t tGenomeCorpus::checksum(const unsigned char *data, size_t length)
+{
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ data[i]) * 16777619U;
+    }
+
+    return hash;
+}
+
+bool tGenomeCorpus::isCorpus(const char *filename)
+{
+    FILE *f = fopen(filename, "rb");
+
+    if (f == NULL)
+    {
+        return false;
+    }
+
+    char magic[8];
+    bool found = fread(magic, 1, sizeof(magic), f) == sizeof(magic) && memcmp(magic, genomeFileMagic, sizeof(magic)) == 0;
+    fclose(f);
+
+    return found;
+}
+
+bool tGenomeCorpus::open(const char *filename)
+{
+    close();
+
+    int fd = ::open(filename, O_RDONLY);
+
+    if (fd < 0)
+    {
+        perror(filename);
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(tGenomeFileHeader))
+    {
+        cerr << "invalid genome file: " << filename << endl;
+        ::close(fd);
+        return false;
+    }
+
+    void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+
+    if (mapped == MAP_FAILED)
+    {
+        perror(filename);
+        return false;
+    }
+
+    base = (const unsigned char *)mapped;
+    mappedSize = info.st_size;
+    header = (const tGenomeFileHeader *)base;
+    index = (const tGenomeFileEntry *)(base + header->indexOffset);
+
+    bool valid = memcmp(header->magic, genomeFileMagic, sizeof(genomeFileMagic)) == 0 &&
+                 header->version == genomeFileVersion && header->headerSize == sizeof(tGenomeFileHeader) &&
+                 header->fileSize == mappedSize && header->indexOffset % 8 == 0 &&
+                 header->indexOffset + header->count * sizeof(tGenomeFileEntry) <= mappedSize;
+
+    if (valid)
+    {
+        valid = checksum((const unsigned char *)index, header->count * sizeof(tGenomeFileEntry)) == header->indexChecksum;
+    }
+
+    for (uint64_t i = 0; valid && i < header->count; ++i)
+    {
+        valid = index[i].offset + index[i].length <= mappedSize;
+    }
+
+    if (!valid)
+    {
+        cerr << "invalid genome file: " << filename << endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void tGenomeCorpus::close(void)
+{
+    if (base != NULL)
+    {
+        munmap((void *)base, mappedSize);
+    }
+
+    base = NULL;
+    mappedSize = 0;
+    header = NULL;
+    index = NULL;
+}
+
+uint64_t tGenomeCorpus::size(void) const
+{
+    return (header == NULL) ? 0 : header->count;
+}
+
+const tGenomeFileEntry &tGenomeCorpus::entry(uint64_t i) const
+{
+    return index[i];
+}
+
+const unsigned char *tGenomeCorpus::genome(uint64_t i) const
+{
+    return base + index[i].offset;
+}
+
+bool tGenomeCorpus::verify(uint64_t i) const
+{
+    return checksum(genome(i), index[i].length) == index[i].checksum;
+}
+
+bool tGenomeCorpus::loadAgent(uint64_t i, tAgent *agent) const
+{
+    if (i >= size() || !verify(i))
+    {
+        cerr << "genome " << i << " failed its checksum" << endl;
+        return false;
+    }
+
+    agent->genome.assign(genome(i), genome(i) + index[i].length);
+    agent->born = index[i].born;
+
+    return true;
+}
+
+// writes the agents' genomes into a single corpus file. sources names the
+// file or run each genome came from and may be empty.
+bool tGenomeCorpus::write(const char *filename, const vector<tAgent*> &agents, const vector<string> &sources)
+{
+    tGenomeFileHeader fileHeader;
+    memset(&fileHeader, 0, sizeof(fileHeader));
+    memcpy(fileHeader.magic, genomeFileMagic, sizeof(genomeFileMagic));
+    fileHeader.version = genomeFileVersion;
+    fileHeader.headerSize = sizeof(fileHeader);
+    fileHeader.count = agents.size();
+    fileHeader.indexOffset = sizeof(fileHeader);
+
+    // genomes start 8-byte aligned after the index
+    vector<tGenomeFileEntry> entries(agents.size());
+    uint64_t offset = fileHeader.indexOffset + agents.size() * sizeof(tGenomeFileEntry);
+
+    for (size_t i = 0; i < agents.size(); ++i)
+    {
+        const vector<unsigned char> &genome = agents[i]->genome;
+
+        memset(&entries[i], 0, sizeof(tGenomeFileEntry));
+        offset = (offset + 7) & ~(uint64_t)7;
+        entries[i].offset = offset;
+        entries[i].length = (uint32_t)genome.size();
+        entries[i].checksum = genome.empty() ? checksum(NULL, 0) : checksum(&genome[0], genome.size());
+        entries[i].ID = agents[i]->ID;
+        entries[i].born = agents[i]->born;
+        entries[i].fitness = agents[i]->fitness;
+
+        if (i < sources.size())
+        {
+            strncpy(entries[i].source, sources[i].c_str(), sizeof(entries[i].source) - 1);
+        }
+
+        offset += genome.size();
+    }
+
+    fileHeader.fileSize = offset;
+    fileHeader.indexChecksum = entries.empty() ? checksum(NULL, 0) : checksum((const unsigned char *)&entries[0], entries.size() * sizeof(tGenomeFileEntry));
+
+    FILE *f = fopen(filename, "wb");
+
+    if (f == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+
+    bool ok = fwrite(&fileHeader, sizeof(fileHeader), 1, f) == 1;
+
+    if (!entries.empty())
+    {
+        ok = ok && fwrite(&entries[0], sizeof(tGenomeFileEntry), entries.size(), f) == entries.size();
+    }
+
+    uint64_t written = fileHeader.indexOffset + entries.size() * sizeof(tGenomeFileEntry);
+    const char padding[8] = { 0 };
+
+    for (size_t i = 0; i < agents.size() && ok; ++i)
+    {
+        ok = fwrite(padding, 1, entries[i].offset - written, f) == entries[i].offset - written;
+        written = entries[i].offset;
+
+        if (entries[i].length > 0)
+        {
+            ok = ok && fwrite(&agents[i]->genome[0], 1, entries[i].length, f) == entries[i].length;
+            written += entries[i].length;
+        }
+    }
+
+    ok = (fclose(f) == 0) && ok;
+
+    if (!ok)
+    {
+        perror(filename);
+    }
+
+    return ok;
+}
@@ -0,0 +1,79 @@
+/*
+ * tGenomeFile.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tGenomeFile_h_included_
+#define _tGenomeFile_h_included_
+
+#include "globalConst.h"
+#include "tAgent.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+#define     genomeFileVersion   1
+
+// binary genome container: a header, an index of fixed-size entries and the
+// raw genome bytes. everything is used in place after mapping the file.
+struct tGenomeFileHeader
+{
+    char magic[8];
+    uint32_t version, headerSize;
+    uint64_t count, indexOffset, fileSize, indexChecksum;
+};
+
+// one genome in the index, with where it came from
+struct tGenomeFileEntry
+{
+    uint64_t offset;
+    uint32_t length, checksum;
+    int32_t ID, born;
+    double fitness;
+    char source[32];
+};
+
+class tGenomeCorpus
+{
+public:
+    tGenomeCorpus();
+    ~tGenomeCorpus();
+    bool open(const char *filename);
+    void close(void);
+    uint64_t size(void) const;
+    const tGenomeFileEntry &entry(uint64_t i) const;
+    const unsigned char *genome(uint64_t i) const;
+    bool verify(uint64_t i) const;
+    bool loadAgent(uint64_t i, tAgent *agent) const;
+
+    static bool isCorpus(const char *filename);
+    static bool write(const char *filename, const vector<tAgent*> &agents, const vector<string> &sources);
+    static uint32_t checksum(const unsigned char *data, size_t length);
+
+private:
+    const unsigned char *base;
+    size_t mappedSize;
+    const tGenomeFileHeader *header;
+    const tGenomeFileEntry *index;
+};
+
+#endif
@@ -48,8 +48,8 @@ void tHMMU::setup(vector<unsigned char> &genome, int start){
 
 	_xDim=1+(genome[(k++)%genome.size()]&3);
 	_yDim=1+(genome[(k++)%genome.size()]&3);
-	posFBNode=genome[(k++)%genome.size()]&(maxNodes-1);
-	negFBNode=genome[(k++)%genome.size()]&(maxNodes-1);
+	posFBNode=genome[(k++)%genome.size()]&(brainNodes-1);
+	negFBNode=genome[(k++)%genome.size()]&(brainNodes-1);
 	nrPos=genome[(k++)%genome.size()]&3;
 	nrNeg=genome[(k++)%genome.size()]&3;
 	//cout<<"setup "<<(int)genome[start+2]<<" "<<(int)xDim<<" "<<(int)yDim<<endl;
@@ -58,9 +58,9 @@ void tHMMU::setup(vector<unsigned char> &genome, int start){
 	posLevelOfFB.resize(nrPos);
 	negLevelOfFB.resize(nrNeg);
 	for(i=0;i<_yDim;i++)
-		ins[i]=genome[(k+i)%genome.size()]&(maxNodes-1);
+		ins[i]=genome[(k+i)%genome.size()]&(brainNodes-1);
 	for(i=0;i<_xDim;i++)
-		outs[i]=genome[(k+4+i)%genome.size()]&(maxNodes-1);
+		outs[i]=genome[(k+4+i)%genome.size()]&(brainNodes-1);
 	for(i=0;i<nrPos;i++)
 		posLevelOfFB[i]=(int)(1+genome[(k+8+i)%genome.size()]);
 	for(i=0;i<nrNeg;i++)
@@ -93,8 +93,8 @@ void tHMMU::setupDeterministic(vector<unsigned char> &genome, int start){
 	
 	_xDim=1+(genome[(k++)%genome.size()]&3);
 	_yDim=1+(genome[(k++)%genome.size()]&3);
-	posFBNode=genome[(k++)%genome.size()]&(maxNodes-1);
-	negFBNode=genome[(k++)%genome.size()]&(maxNodes-1);
+	posFBNode=genome[(k++)%genome.size()]&(brainNodes-1);
+	negFBNode=genome[(k++)%genome.size()]&(brainNodes-1);
 	nrPos=genome[(k++)%genome.size()]&3;
 	nrNeg=genome[(k++)%genome.size()]&3;
 	//cout<<"setup "<<(int)genome[start+2]<<" "<<(int)xDim<<" "<<(int)yDim<<endl;
@@ -103,9 +103,9 @@ void tHMMU::setupDeterministic(vector<unsigned char> &genome, int start){
 	posLevelOfFB.resize(nrPos);
 	negLevelOfFB.resize(nrNeg);
 	for(i=0;i<_yDim;i++)
-		ins[i]=genome[(k+i)%genome.size()]&(maxNodes-1);
+		ins[i]=genome[(k+i)%genome.size()]&(brainNodes-1);
 	for(i=0;i<_xDim;i++)
-		outs[i]=genome[(k+4+i)%genome.size()]&(maxNodes-1);
+		outs[i]=genome[(k+4+i)%genome.size()]&(brainNodes-1);
 	for(i=0;i<nrPos;i++)
 		posLevelOfFB[i]=(int)(1+genome[(k+8+i)%genome.size()]);
 	for(i=0;i<nrNeg;i++)
@@ -151,7 +151,7 @@ void tHMMU::update(unsigned char *states, unsigned char *newStates)
     {
 		for(i=0;i<chosenInPos.size();i++)
         {
-			mod=(unsigned char)(rand()%(int)posLevelOfFB[i]);
+			mod=(unsigned char)(eddRand()%(int)posLevelOfFB[i]);
 			if((hmm[chosenInPos[i]][chosenOutPos[i]]+mod)<255)
             {
 				hmm[chosenInPos[i]][chosenOutPos[i]]+=mod;
@@ -163,7 +163,7 @@ void tHMMU::update(unsigned char *states, unsigned char *newStates)
     {
 		for(i=0;i<chosenInNeg.size();i++)
         {
-			mod=(unsigned char)(rand()%(int)negLevelOfFB[i]);
+			mod=(unsigned char)(eddRand()%(int)negLevelOfFB[i]);
 			if((hmm[chosenInNeg[i]][chosenOutNeg[i]]-mod)>0)
             {
 				hmm[chosenInNeg[i]][chosenOutNeg[i]]-=mod;
@@ -178,7 +178,7 @@ void tHMMU::update(unsigned char *states, unsigned char *newStates)
 		I=(I<<1)+((states[*it])&1);
     }
     
-	r=1+(rand()%(sums[I]-1));
+	r=1+(eddRand()%(sums[I]-1));
 	j=0;
     //	cout<<I<<" "<<(int)hmm.size()<<" "<<(int)hmm[0].size()<<endl;
 	while(r > hmm[I][j])
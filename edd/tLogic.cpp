@@ -0,0 +1,790 @@
+/*
+ * tLogic.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tLogic.h"
+#include "tAgent.h"
+#include "globalConst.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+
+// lane patterns of the first six inputs within a word of 64 combinations
+static const uint64_t laneInputs[6] =
+{
+    0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+    0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+};
+
+// the retina of the default 3x3 camera, and the actuators in the order
+// tGame reads them: up, down, left, right, zoom in, zoom out, the ten
+// classification bits and the ten veto bits
+void logicDefaultNodes(vector<int> &inputs, vector<int> &outputs)
+{
+    inputs.clear();
+    outputs.clear();
+    
+    for (int node = 0; node < 9; ++node)
+    {
+        inputs.push_back(node);
+    }
+    
+    for (int node = brainNodes - 1; node >= brainNodes - 26; --node)
+    {
+        outputs.push_back(node);
+    }
+}
+
+// reads a comma-separated list of nodes and ranges of nodes, e.g. "0-8,12"
+bool parseLogicNodes(const char *text, vector<int> &nodes)
+{
+    nodes.clear();
+    
+    while (*text != '\0')
+    {
+        char *end;
+        long first = strtol(text, &end, 10), last = first;
+        
+        if (end == text)
+        {
+            return false;
+        }
+        
+        if (*end == '-')
+        {
+            text = end + 1;
+            last = strtol(text, &end, 10);
+            
+            if (end == text)
+            {
+                return false;
+            }
+        }
+        
+        if (first < 0 || last >= maxNodes || first > last)
+        {
+            return false;
+        }
+        
+        for (long node = first; node <= last; ++node)
+        {
+            if (find(nodes.begin(), nodes.end(), (int)node) != nodes.end())
+            {
+                return false;
+            }
+            
+            nodes.push_back((int)node);
+        }
+        
+        if (*end == ',')
+        {
+            ++end;
+        }
+        else if (*end != '\0')
+        {
+            return false;
+        }
+        
+        text = end;
+    }
+    
+    return !nodes.empty();
+}
+
+// column name of a node: actuators by what they do, everything else as a sensor
+string logicNodeName(int node)
+{
+    static const char *movements[6] = { "up", "down", "left", "right", "zoomin", "zoomout" };
+    char name[16];
+    
+    if (node >= brainNodes - 6)
+    {
+        return movements[brainNodes - 1 - node];
+    }
+    else if (node >= brainNodes - 16)
+    {
+        snprintf(name, sizeof(name), "c%d", brainNodes - 7 - node);
+    }
+    else if (node >= brainNodes - 26)
+    {
+        snprintf(name, sizeof(name), "v%d", brainNodes - 17 - node);
+    }
+    else if (node == brainNodes - 27)
+    {
+        return "ready";
+    }
+    else
+    {
+        snprintf(name, sizeof(name), "s%d", node);
+    }
+    
+    return name;
+}
+
+// the output index a gate picks for each input row, or -1 if the row is stochastic
+int deterministicOutput(tHMMU *gate, int row)
+{
+    int chosen = -1;
+    
+    for (int j = 0; j < gate->hmm[row].size(); ++j)
+    {
+        if (gate->hmm[row][j] != 0)
+        {
+            if (chosen >= 0)
+            {
+                return -1;
+            }
+            
+            chosen = j;
+        }
+    }
+    
+    return chosen;
+}
+
+bool brainIsDeterministic(tAgent *agent)
+{
+    for (int g = 0; g < agent->hmmus.size(); ++g)
+    {
+        for (int row = 0; row < agent->hmmus[g]->hmm.size(); ++row)
+        {
+            if (deterministicOutput(agent->hmmus[g], row) < 0)
+            {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+// deterministic brains: every node is a word of 64 combinations, and each gate
+// ORs the minterm of every input row into the outputs that row switches on, so
+// each combination is evaluated exactly once
+static void extractDeterministic(tAgent *agent, tLogicTable &table, int words, uint64_t validLanes)
+{
+    uint64_t nodes[maxNodes], newNodes[maxNodes];
+    vector< vector<int> > rowOutputs(agent->hmmus.size());
+    
+    for (int g = 0; g < agent->hmmus.size(); ++g)
+    {
+        for (int row = 0; row < agent->hmmus[g]->hmm.size(); ++row)
+        {
+            rowOutputs[g].push_back(deterministicOutput(agent->hmmus[g], row));
+        }
+    }
+    
+    for (int w = 0; w < words; ++w)
+    {
+        memset(nodes, 0, sizeof(nodes));
+        memset(newNodes, 0, sizeof(newNodes));
+        
+        for (int k = 0; k < table.inputs.size(); ++k)
+        {
+            nodes[table.inputs[k]] = (k < 6) ? laneInputs[k] : (((w >> (k - 6)) & 1) ? ~0ULL : 0ULL);
+        }
+        
+        for (int g = 0; g < agent->hmmus.size(); ++g)
+        {
+            tHMMU *gate = agent->hmmus[g];
+            int gateInputs = (int)gate->ins.size();
+            
+            for (int row = 0; row < (1 << gateInputs); ++row)
+            {
+                int output = rowOutputs[g][row];
+                
+                if (output == 0)
+                {
+                    continue;
+                }
+                
+                // the first input is the most significant bit of the row
+                uint64_t minterm = ~0ULL;
+                
+                for (int i = 0; i < gateInputs; ++i)
+                {
+                    uint64_t input = nodes[gate->ins[i]];
+                    minterm &= ((row >> (gateInputs - 1 - i)) & 1) ? input : ~input;
+                }
+                
+                for (int o = 0; o < gate->outs.size(); ++o)
+                {
+                    if ((output >> o) & 1)
+                    {
+                        newNodes[gate->outs[o]] |= minterm;
+                    }
+                }
+            }
+        }
+        
+        for (int o = 0; o < table.outputs.size(); ++o)
+        {
+            table.columns[o][w] = newNodes[table.outputs[o]] & validLanes;
+        }
+    }
+}
+
+// stochastic brains: each word of 64 combinations is sampled by one thread from
+// its own seed, so the table does not depend on the number of threads. samples
+// are keyed with the first output as the most significant bit, and ties go to
+// the smallest key, as the old per-row map did.
+static void extractStochastic(tAgent *agent, tLogicTable &table, int words, int combinations)
+{
+    atomic<int> nextWord(0);
+    int outputCount = (int)table.outputs.size();
+    
+    auto sample = [&]()
+    {
+        unsigned char states[maxNodes], newStates[maxNodes];
+        vector<uint64_t> keys(table.samples);
+        
+        for (int w = nextWord++; w < words; w = nextWord++)
+        {
+            eddSrand((unsigned int)w + 1);
+            
+            for (int lane = 0; lane < 64 && w * 64 + lane < combinations; ++lane)
+            {
+                int combination = w * 64 + lane;
+                
+                for (int repeat = 0; repeat < table.samples; ++repeat)
+                {
+                    memset(states, 0, sizeof(states));
+                    memset(newStates, 0, sizeof(newStates));
+                    
+                    for (int k = 0; k < table.inputs.size(); ++k)
+                    {
+                        states[table.inputs[k]] = (combination >> k) & 1;
+                    }
+                    
+                    for (int g = 0; g < agent->hmmus.size(); ++g)
+                    {
+                        agent->hmmus[g]->update(states, newStates);
+                    }
+                    
+                    uint64_t key = 0;
+                    
+                    for (int o = 0; o < outputCount; ++o)
+                    {
+                        key = (key << 1) | (newStates[table.outputs[o]] & 1);
+                    }
+                    
+                    keys[repeat] = key;
+                }
+                
+                sort(keys.begin(), keys.end());
+                
+                uint64_t mostCommon = keys[0];
+                int bestCount = 0;
+                
+                for (int first = 0, last; first < keys.size(); first = last)
+                {
+                    for (last = first; last < keys.size() && keys[last] == keys[first]; ++last);
+                    
+                    if (last - first > bestCount)
+                    {
+                        bestCount = last - first;
+                        mostCommon = keys[first];
+                    }
+                }
+                
+                for (int o = 0; o < outputCount; ++o)
+                {
+                    if ((mostCommon >> (outputCount - 1 - o)) & 1)
+                    {
+                        table.columns[o][w] |= 1ULL << lane;
+                    }
+                }
+            }
+        }
+    };
+    
+    int threadCount = max(1, min((int)thread::hardware_concurrency(), words));
+    vector<thread> threads;
+    
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.push_back(thread(sample));
+    }
+    
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads[t].join();
+    }
+}
+
+// builds the logic table of agent's phenotype over the given input and output
+// nodes (at most maxLogicInputs and maxLogicOutputs of them)
+void extractLogicTable(tAgent *agent, const vector<int> &inputs, const vector<int> &outputs, tLogicTable &table,
+                       int samples)
+{
+    int combinations = 1 << inputs.size();
+    int words = (combinations + 63) / 64;
+    
+    table.inputs = inputs;
+    table.outputs = outputs;
+    table.deterministic = brainIsDeterministic(agent);
+    table.samples = table.deterministic ? 1 : samples;
+    table.columns.assign(outputs.size(), vector<uint64_t>(words, 0));
+    
+    if (table.deterministic)
+    {
+        extractDeterministic(agent, table, words, (combinations >= 64) ? ~0ULL : (1ULL << combinations) - 1);
+    }
+    else
+    {
+        extractStochastic(agent, table, words, combinations);
+    }
+}
+
+// writes the table as csv for the Logic Friday logic optimization program:
+// the inputs, an empty column, then the outputs
+bool writeLogicTable(const tLogicTable &table, const char *filename)
+{
+    FILE *f = fopen(filename, "w");
+    
+    if (f == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+    
+    string text;
+    
+    for (int k = 0; k < table.inputs.size(); ++k)
+    {
+        text += logicNodeName(table.inputs[k]) + ",";
+    }
+    
+    for (int o = 0; o < table.outputs.size(); ++o)
+    {
+        text += "," + logicNodeName(table.outputs[o]);
+    }
+    
+    text += "\n";
+    
+    uint32_t combinations = 1U << table.inputs.size();
+    
+    for (uint32_t combination = 0; combination < combinations; ++combination)
+    {
+        for (int k = 0; k < table.inputs.size(); ++k)
+        {
+            text.push_back('0' + ((combination >> k) & 1));
+            text.push_back(',');
+        }
+        
+        for (int o = 0; o < table.outputs.size(); ++o)
+        {
+            text.push_back(',');
+            text.push_back('0' + table.value(o, combination));
+        }
+        
+        text.push_back('\n');
+        
+        if (text.size() >= (1 << 20))
+        {
+            fwrite(text.data(), 1, text.size(), f);
+            text.clear();
+        }
+    }
+    
+    fwrite(text.data(), 1, text.size(), f);
+    
+    return fclose(f) == 0;
+}
+
+#define     maxExactSupport     8
+
+// exact two-level minimization of a node that depends on at most
+// maxExactSupport nodes: the on-set is enumerated over the node's support,
+// all prime implicants are found by merging (Quine-McCluskey), and primes are
+// picked greedily until they cover the on-set
+static void minimizeExact(vector<tLogicCube> &cubes, uint64_t support)
+{
+    vector<int> supportNodes;
+    
+    for (int node = 0; node < 64; ++node)
+    {
+        if ((support >> node) & 1)
+        {
+            supportNodes.push_back(node);
+        }
+    }
+    
+    int variables = (int)supportNodes.size();
+    uint32_t fullMask = (1U << variables) - 1;
+    vector<uint32_t> onSet;
+    
+    for (uint32_t minterm = 0; minterm <= fullMask; ++minterm)
+    {
+        uint64_t states = 0;
+        
+        for (int v = 0; v < variables; ++v)
+        {
+            states |= (uint64_t)((minterm >> v) & 1) << supportNodes[v];
+        }
+        
+        for (int cube = 0; cube < cubes.size(); ++cube)
+        {
+            if (((states ^ cubes[cube].value) & cubes[cube].mask) == 0)
+            {
+                onSet.push_back(minterm);
+                break;
+            }
+        }
+    }
+    
+    // implicants are keyed as mask << 32 | value over the support's variables
+    vector<uint64_t> implicants, primes;
+    
+    for (int i = 0; i < onSet.size(); ++i)
+    {
+        implicants.push_back(((uint64_t)fullMask << 32) | onSet[i]);
+    }
+    
+    while (!implicants.empty())
+    {
+        vector<uint64_t> merged;
+        vector<bool> used(implicants.size(), false);
+        
+        for (int i = 0; i < implicants.size(); ++i)
+        {
+            uint32_t mask = (uint32_t)(implicants[i] >> 32), value = (uint32_t)implicants[i];
+            
+            for (int v = 0; v < variables; ++v)
+            {
+                uint32_t bit = 1U << v;
+                
+                if ((mask & bit) == 0 || (value & bit) != 0)
+                {
+                    continue;
+                }
+                
+                uint64_t partner = implicants[i] | bit;
+                vector<uint64_t>::iterator found = lower_bound(implicants.begin(), implicants.end(), partner);
+                
+                if (found != implicants.end() && *found == partner)
+                {
+                    used[i] = used[found - implicants.begin()] = true;
+                    merged.push_back(((uint64_t)(mask & ~bit) << 32) | value);
+                }
+            }
+            
+            // partners have larger keys, so every merge with i has been seen
+            if (!used[i])
+            {
+                primes.push_back(implicants[i]);
+            }
+        }
+        
+        // lower_bound needs the implicants in order
+        sort(merged.begin(), merged.end());
+        merged.erase(unique(merged.begin(), merged.end()), merged.end());
+        implicants.swap(merged);
+    }
+    
+    // the on-set minterms each prime covers, as bit sets
+    int words = (int)(onSet.size() + 63) / 64;
+    vector< vector<uint64_t> > primeCovers(primes.size(), vector<uint64_t>(words, 0));
+    vector<uint64_t> uncovered(words, 0);
+    
+    for (int m = 0; m < onSet.size(); ++m)
+    {
+        uncovered[m / 64] |= 1ULL << (m % 64);
+        
+        for (int p = 0; p < primes.size(); ++p)
+        {
+            if (((onSet[m] ^ (uint32_t)primes[p]) & (uint32_t)(primes[p] >> 32)) == 0)
+            {
+                primeCovers[p][m / 64] |= 1ULL << (m % 64);
+            }
+        }
+    }
+    
+    cubes.clear();
+    
+    for (int remaining = (int)onSet.size(); remaining > 0; )
+    {
+        int best = -1, bestCount = 0;
+        
+        for (int p = 0; p < primes.size(); ++p)
+        {
+            int count = 0;
+            
+            for (int w = 0; w < words; ++w)
+            {
+                count += __builtin_popcountll(primeCovers[p][w] & uncovered[w]);
+            }
+            
+            // fewer literals break ties
+            if (count > bestCount || (count == bestCount && count > 0 && __builtin_popcount((uint32_t)(primes[p] >> 32)) <
+                                      __builtin_popcount((uint32_t)(primes[best] >> 32))))
+            {
+                best = p;
+                bestCount = count;
+            }
+        }
+        
+        uint32_t mask = (uint32_t)(primes[best] >> 32), value = (uint32_t)primes[best];
+        tLogicCube cube = { 0, 0 };
+        
+        for (int v = 0; v < variables; ++v)
+        {
+            if ((mask >> v) & 1)
+            {
+                cube.mask |= 1ULL << supportNodes[v];
+                cube.value |= (uint64_t)((value >> v) & 1) << supportNodes[v];
+            }
+        }
+        
+        cubes.push_back(cube);
+        remaining -= bestCount;
+        
+        for (int w = 0; w < words; ++w)
+        {
+            uncovered[w] &= ~primeCovers[best][w];
+        }
+    }
+}
+
+// nodes with a larger support are simplified in place instead: products
+// implied by a more general one are dropped, and a product that differs from
+// a more general one only in the value of one of its nodes loses that node
+// (pv + pqv' = pv + pq), until neither applies
+static void minimizeCubes(vector<tLogicCube> &cubes)
+{
+    bool changed = true;
+    
+    while (changed)
+    {
+        changed = false;
+        vector<bool> removed(cubes.size(), false);
+        
+        for (int a = 0; a < cubes.size(); ++a)
+        {
+            for (int b = 0; b < cubes.size() && !removed[a]; ++b)
+            {
+                if (a == b || removed[b])
+                {
+                    continue;
+                }
+                
+                uint64_t difference = (cubes[a].value ^ cubes[b].value) & cubes[a].mask;
+                
+                if ((cubes[a].mask & cubes[b].mask) != cubes[a].mask)
+                {
+                    continue;
+                }
+                
+                // a covers b
+                if (difference == 0)
+                {
+                    removed[b] = true;
+                    changed = true;
+                }
+                
+                // b does not need the node in which it differs from a
+                else if (__builtin_popcountll(difference) == 1)
+                {
+                    cubes[b].mask &= ~difference;
+                    cubes[b].value &= ~difference;
+                    changed = true;
+                }
+            }
+        }
+        
+        int kept = 0;
+        
+        for (int cube = 0; cube < cubes.size(); ++cube)
+        {
+            if (!removed[cube])
+            {
+                cubes[kept++] = cubes[cube];
+            }
+        }
+        
+        cubes.resize(kept);
+    }
+}
+
+// every row of every gate that switches an output on is a product over the
+// gate's inputs; a node's next value is the OR of the products written to it.
+// fails on stochastic brains and on brains wider than 64 nodes.
+bool tLogicNetwork::build(tAgent *agent)
+{
+    if (brainNodes != 64 || !brainIsDeterministic(agent))
+    {
+        return false;
+    }
+    
+    vector<tLogicCube> nodeCubes[64];
+    
+    gates = (int)agent->hmmus.size();
+    gateRows = 0;
+    
+    for (int g = 0; g < agent->hmmus.size(); ++g)
+    {
+        tHMMU *gate = agent->hmmus[g];
+        int gateInputs = (int)gate->ins.size();
+        
+        for (int row = 0; row < (1 << gateInputs); ++row)
+        {
+            int output = deterministicOutput(gate, row);
+            tLogicCube cube = { 0, 0 };
+            bool possible = true;
+            
+            ++gateRows;
+            
+            if (output == 0)
+            {
+                continue;
+            }
+            
+            // the first input is the most significant bit of the row. a gate that
+            // reads a node twice can ask for both of its values at once.
+            for (int i = 0; i < gateInputs; ++i)
+            {
+                uint64_t node = 1ULL << gate->ins[i];
+                uint64_t value = ((row >> (gateInputs - 1 - i)) & 1) ? node : 0;
+                
+                if ((cube.mask & node) != 0 && (cube.value & node) != value)
+                {
+                    possible = false;
+                }
+                
+                cube.mask |= node;
+                cube.value |= value;
+            }
+            
+            for (int o = 0; possible && o < gate->outs.size(); ++o)
+            {
+                if ((output >> o) & 1)
+                {
+                    nodeCubes[gate->outs[o]].push_back(cube);
+                }
+            }
+        }
+    }
+    
+    nodes.clear();
+    cubes.clear();
+    firstCube.assign(1, 0);
+    
+    for (int node = 0; node < 64; ++node)
+    {
+        if (nodeCubes[node].empty())
+        {
+            continue;
+        }
+        
+        uint64_t support = 0;
+        
+        for (int cube = 0; cube < nodeCubes[node].size(); ++cube)
+        {
+            support |= nodeCubes[node][cube].mask;
+        }
+        
+        if (__builtin_popcountll(support) <= maxExactSupport)
+        {
+            minimizeExact(nodeCubes[node], support);
+        }
+        else
+        {
+            minimizeCubes(nodeCubes[node]);
+        }
+        
+        if (nodeCubes[node].empty())
+        {
+            continue;
+        }
+        
+        // cheapest products first, so the most likely match is tried first
+        sort(nodeCubes[node].begin(), nodeCubes[node].end(), [](const tLogicCube &a, const tLogicCube &b)
+        {
+            return __builtin_popcountll(a.mask) < __builtin_popcountll(b.mask);
+        });
+        
+        nodes.push_back(node);
+        cubes.insert(cubes.end(), nodeCubes[node].begin(), nodeCubes[node].end());
+        firstCube.push_back((int)cubes.size());
+    }
+    
+    return true;
+}
+
+int tLogicNetwork::literals(void) const
+{
+    int count = 0;
+    
+    for (int cube = 0; cube < cubes.size(); ++cube)
+    {
+        count += __builtin_popcountll(cubes[cube].mask);
+    }
+    
+    return count;
+}
+
+// writes one line per node, e.g. "c3 = s0 & ~s4 | s12", after a summary of
+// how much smaller the network is than the gates it came from
+bool tLogicNetwork::write(const char *filename) const
+{
+    FILE *f = fopen(filename, "w");
+    
+    if (f == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+    
+    fprintf(f, "# %d gates with %d rows minimized to %d products with %d literals over %d nodes\n", gates,
+            gateRows, (int)cubes.size(), literals(), (int)nodes.size());
+    
+    for (int n = 0; n < nodes.size(); ++n)
+    {
+        string line = logicNodeName(nodes[n]) + " =";
+        
+        for (int cube = firstCube[n]; cube < firstCube[n + 1]; ++cube)
+        {
+            line += (cube == firstCube[n]) ? " " : " | ";
+            
+            if (cubes[cube].mask == 0)
+            {
+                line += "1";
+            }
+            
+            for (int node = 0, first = 1; node < 64; ++node)
+            {
+                if ((cubes[cube].mask >> node) & 1)
+                {
+                    line += first ? "" : " & ";
+                    line += ((cubes[cube].value >> node) & 1) ? "" : "~";
+                    line += logicNodeName(node);
+                    first = 0;
+                }
+            }
+        }
+        
+        fprintf(f, "%s\n", line.c_str());
+    }
+    
+    return fclose(f) == 0;
+}
@@ -0,0 +1,131 @@
+/*
+ * tLogic.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tLogic_h_included_
+#define _tLogic_h_included_
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <string>
+#include "globalConst.h"
+
+using namespace std;
+
+class tAgent;
+class tHMMU;
+
+#define     maxLogicInputs      24
+#define     maxLogicOutputs     64
+
+// what one brain update computes from a reset brain: for every combination of
+// the input nodes (all other nodes 0), the value of each output node. bit c of
+// columns[o] is output o for the combination whose bit k is input k. stochastic
+// brains get the most common output of [samples] updates per combination.
+struct tLogicTable
+{
+    vector<int> inputs, outputs;
+    vector< vector<uint64_t> > columns;
+    bool deterministic;
+    int samples;
+
+    bool value(int output, uint32_t combination) const
+    {
+        return (columns[output][combination >> 6] >> (combination & 63)) & 1;
+    }
+};
+
+// one product term of a node's next value: true when every node in mask has
+// its bit in value
+struct tLogicCube
+{
+    uint64_t mask, value;
+};
+
+// a deterministic 64-node brain as the minimized sum of products of each node
+// it writes, over the nodes packed into a word. one update gives exactly the
+// states the brain's gates would.
+class tLogicNetwork
+{
+public:
+    vector<int> nodes;
+    vector<int> firstCube;
+    vector<tLogicCube> cubes;
+    int gates, gateRows;
+    unsigned long long phenotype;
+
+    // the same logic as native code, once compileNative has loaded it
+    uint64_t (*native)(uint64_t);
+
+    tLogicNetwork() : native(NULL) { }
+    bool build(tAgent *agent);
+    int literals(void) const;
+    bool write(const char *filename) const;
+
+    uint64_t update(uint64_t states) const
+    {
+        if (native != NULL)
+        {
+            return native(states);
+        }
+
+        uint64_t next = 0;
+
+        for (int n = 0; n < nodes.size(); ++n)
+        {
+            for (int cube = firstCube[n]; cube < firstCube[n + 1]; ++cube)
+            {
+                if (((states ^ cubes[cube].value) & cubes[cube].mask) == 0)
+                {
+                    next |= 1ULL << nodes[n];
+                    break;
+                }
+            }
+        }
+
+        return next;
+    }
+
+    // node i is bit i of the packed word (see tBrainWidth)
+    static uint64_t pack(const unsigned char *states)
+    {
+        tBrainWidth<64>::tPacked packed;
+        tBrainWidth<64>::pack(states, packed);
+        return packed.word[0];
+    }
+
+    static void unpack(uint64_t packed, unsigned char *states)
+    {
+        tBrainWidth<64>::tPacked words = { { packed } };
+        tBrainWidth<64>::unpack(words, states);
+    }
+};
+
+void    logicDefaultNodes(vector<int> &inputs, vector<int> &outputs);
+bool    parseLogicNodes(const char *text, vector<int> &nodes);
+string  logicNodeName(int node);
+int     deterministicOutput(tHMMU *gate, int row);
+bool    brainIsDeterministic(tAgent *agent);
+void    extractLogicTable(tAgent *agent, const vector<int> &inputs, const vector<int> &outputs, tLogicTable &table,
+                          int samples = 1000);
+bool    writeLogicTable(const tLogicTable &table, const char *filename);
+
+#endif
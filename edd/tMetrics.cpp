@@ -0,0 +1,382 @@
+/*
+ * tMetrics.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tMetrics.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <map>
+#include <iostream>
+
+static const char metricsMagic[8] = { 'E', 'D', 'D', 'M', 'E', 'T', 'R', 'C' };
+
+tAccumulator::tAccumulator()
+{
+    reset();
+}
+
+void tAccumulator::reset(void)
+{
+    count = 0;
+    minimum = 0.0;
+    maximum = 0.0;
+    runningMean = 0.0;
+    sumSqDist = 0.0;
+}
+
+void tAccumulator::add(double value)
+{
+    ++count;
+    
+    if (count == 1 || value < minimum)
+    {
+        minimum = value;
+    }
+    
+    if (count == 1 || value > maximum)
+    {
+        maximum = value;
+    }
+    
+    double delta = value - runningMean;
+    runningMean += delta / (double)count;
+    sumSqDist += delta * (value - runningMean);
+}
+
+double tAccumulator::mean(void) const
+{
+    return runningMean;
+}
+
+// population variance, like tGame::variance
+double tAccumulator::variance(void) const
+{
+    return (count == 0) ? 0.0 : sumSqDist / (double)count;
+}
+
+tMetricsLog::tMetricsLog()
+{
+    file = NULL;
+}
+
+tMetricsLog::~tMetricsLog()
+{
+    close();
+}
+
+void tMetricsLog::setupHeader(tMetricsHeader &header)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, metricsMagic, sizeof(metricsMagic));
+    header.version = metricsVersion;
+    header.headerSize = sizeof(tMetricsHeader);
+    header.recordSize = sizeof(tMetricsRecord);
+}
+
+// runs are only compared if all of their game parameters match, so the hash
+// covers them even where the text had to be cut short
+void tMetricsLog::setGame(tMetricsHeader &header, const string &parameters)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    
+    for (size_t i = 0; i < parameters.size(); ++i)
+    {
+        hash = (hash ^ (unsigned char)parameters[i]) * 1099511628211ULL;
+    }
+    
+    header.gameHash = hash;
+    memset(header.game, 0, sizeof(header.game));
+    strncpy(header.game, parameters.c_str(), sizeof(header.game) - 1);
+}
+
+void tMetricsLog::fillRecord(tMetricsRecord &record, const tAccumulator &fitness, const tAccumulator &genome, const tAccumulator &gates)
+{
+    record.fitnessMin = fitness.minimum;
+    record.fitnessMean = fitness.mean();
+    record.fitnessMax = fitness.maximum;
+    record.fitnessVariance = fitness.variance();
+    record.genomeMin = genome.minimum;
+    record.genomeMean = genome.mean();
+    record.genomeMax = genome.maximum;
+    record.genomeVariance = genome.variance();
+    record.gatesMin = gates.minimum;
+    record.gatesMean = gates.mean();
+    record.gatesMax = gates.maximum;
+    record.gatesVariance = gates.variance();
+}
+
+void tMetricsLog::fillProfile(tMetricsRecord &record, const tProfileData &profile)
+{
+    for (int phase = 0; phase < profilePhases; ++phase)
+    {
+        record.phaseSeconds[phase] = profileSeconds(profile.ticks[phase]);
+    }
+    
+    for (int counter = 0; counter < profileCounters; ++counter)
+    {
+        record.profileCounts[counter] = profile.counts[counter];
+    }
+    
+    memcpy(record.phaseEvents, profile.events, sizeof(record.phaseEvents));
+}
+
+// starts a new metrics file, or, when a run resumes at firstGeneration,
+// keeps the existing file up to the generation before it. a file with
+// records of another layout is left alone rather than thrown away.
+bool tMetricsLog::open(const char *filename, const tMetricsHeader &header, int firstGeneration)
+{
+    close();
+    
+    if (firstGeneration > 1 && (file = fopen(filename, "r+b")) != NULL)
+    {
+        tMetricsHeader existing;
+        tMetricsRecord record;
+        long keep = sizeof(existing);
+        
+        if (fread(&existing, sizeof(existing), 1, file) == 1)
+        {
+            if (memcmp(existing.magic, metricsMagic, sizeof(metricsMagic)) != 0 ||
+                existing.headerSize != sizeof(existing) || existing.recordSize != sizeof(record))
+            {
+                cerr << filename << " is not a metrics file of this version of edd; not resuming its metrics" << endl;
+                fclose(file);
+                file = NULL;
+                return false;
+            }
+            
+            while (fread(&record, sizeof(record), 1, file) == 1 && record.generation < firstGeneration)
+            {
+                keep += sizeof(record);
+            }
+            
+            // the resumed run may go on for more generations than the first
+            existing.totalGenerations = header.totalGenerations;
+            
+            if (fseek(file, 0, SEEK_SET) == 0 && fwrite(&existing, sizeof(existing), 1, file) == 1 && fflush(file) == 0 &&
+                ftruncate(fileno(file), keep) == 0 && fseek(file, keep, SEEK_SET) == 0)
+            {
+                return true;
+            }
+            
+            perror(filename);
+            fclose(file);
+            file = NULL;
+            return false;
+        }
+        
+        fclose(file);
+    }
+    
+    file = fopen(filename, "wb");
+    
+    if (file == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+    
+    fwrite(&header, sizeof(header), 1, file);
+    fflush(file);
+    
+    return true;
+}
+
+// appends a generation; flushed right away so running or killed runs can
+// be aggregated too
+void tMetricsLog::write(const tMetricsRecord &record)
+{
+    if (file != NULL)
+    {
+        fwrite(&record, sizeof(record), 1, file);
+        fflush(file);
+    }
+}
+
+void tMetricsLog::close(void)
+{
+    if (file != NULL)
+    {
+        fclose(file);
+        file = NULL;
+    }
+}
+
+// runs that share a configuration
+struct tMetricsGroup
+{
+    int32_t populationSize;
+    string selection;
+    double perSiteMutationRate;
+    string game;
+    int runs;
+    double bestMean;
+    int bestGeneration;
+    string bestRun;
+    tAccumulator finalMean, finalMax, generations, evaluationsPerSecond;
+    uint64_t farmEvaluations, farmCacheHits;
+};
+
+bool aggregateMetrics(const char *outFilename, const vector<string> &metricsFiles)
+{
+    map<string, tMetricsGroup> groups;
+    int runs = 0;
+    
+    for (int i = 0; i < metricsFiles.size(); ++i)
+    {
+        const char *filename = metricsFiles[i].c_str();
+        int fd = ::open(filename, O_RDONLY);
+        struct stat info;
+        
+        if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(tMetricsHeader))
+        {
+            cerr << "skipping invalid metrics file: " << filename << endl;
+            
+            if (fd >= 0)
+            {
+                ::close(fd);
+            }
+            
+            continue;
+        }
+        
+        void *mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        
+        if (mapped == MAP_FAILED)
+        {
+            perror(filename);
+            continue;
+        }
+        
+        const unsigned char *base = (const unsigned char *)mapped;
+        const tMetricsHeader *header = (const tMetricsHeader *)base;
+        
+        // older files have shorter headers and records; only the fields they share are read
+        if (memcmp(header->magic, metricsMagic, sizeof(metricsMagic)) != 0 ||
+            header->headerSize < metricsHeaderSizeV3 || header->recordSize < metricsRecordSizeV1)
+        {
+            cerr << "skipping invalid metrics file: " << filename << endl;
+            munmap(mapped, info.st_size);
+            continue;
+        }
+        
+        size_t count = (info.st_size - header->headerSize) / header->recordSize;
+        
+        if (count == 0)
+        {
+            munmap(mapped, info.st_size);
+            continue;
+        }
+        
+        char selection[sizeof(header->selection) + 1] = { 0 };
+        memcpy(selection, header->selection, sizeof(header->selection));
+        
+        // files before version 4 don't say what game their runs played
+        char game[sizeof(header->game) + 1] = { 0 };
+        unsigned long long gameHash = 0;
+        
+        if (header->headerSize >= sizeof(tMetricsHeader))
+        {
+            memcpy(game, header->game, sizeof(header->game));
+            gameHash = header->gameHash;
+        }
+        
+        char key[128];
+        snprintf(key, sizeof(key), "%08d %s %g %016llx", header->populationSize, selection, header->perSiteMutationRate, gameHash);
+        
+        bool newGroup = groups.count(key) == 0;
+        tMetricsGroup &group = groups[key];
+        
+        if (newGroup)
+        {
+            group.populationSize = header->populationSize;
+            group.selection = selection;
+            group.perSiteMutationRate = header->perSiteMutationRate;
+            group.game = game;
+            group.runs = 0;
+            group.bestMean = -1.0;
+            group.bestGeneration = 0;
+            group.farmEvaluations = 0;
+            group.farmCacheHits = 0;
+        }
+        
+        ++group.runs;
+        ++runs;
+        
+        const tMetricsRecord *record = NULL;
+        tAccumulator evaluationsPerSecond;
+        
+        for (size_t r = 0; r < count; ++r)
+        {
+            record = (const tMetricsRecord *)(base + header->headerSize + r * header->recordSize);
+            
+            if (record->fitnessMean > group.bestMean)
+            {
+                group.bestMean = record->fitnessMean;
+                group.bestGeneration = record->generation;
+                group.bestRun = filename;
+            }
+            
+            evaluationsPerSecond.add(record->evaluationsPerSecond);
+            group.farmEvaluations += record->farmEvaluations;
+            group.farmCacheHits += record->farmCacheHits;
+        }
+        
+        group.finalMean.add(record->fitnessMean);
+        group.finalMax.add(record->fitnessMax);
+        group.generations.add(record->generation);
+        group.evaluationsPerSecond.add(evaluationsPerSecond.mean());
+        
+        munmap(mapped, info.st_size);
+    }
+    
+    FILE *out = fopen(outFilename, "w");
+    
+    if (out == NULL)
+    {
+        perror(outFilename);
+        return false;
+    }
+    
+    fprintf(out, "population_size,selection,mutation_rate,game,runs,best_mean_fitness,best_mean_generation,best_mean_run,"
+                 "final_mean_fitness,final_max_fitness,final_max_fitness_sd,generations,evaluations_per_second,farm_cache_hit_rate\n");
+    
+    for (map<string, tMetricsGroup>::iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+        tMetricsGroup &group = it->second;
+        double hitRate = (group.farmEvaluations == 0) ? 0.0 : (double)group.farmCacheHits / (double)group.farmEvaluations;
+        
+        fprintf(out, "%d,%s,%g,\"%s\",%d,%f,%d,%s,%f,%f,%f,%.1f,%.1f,%f\n", group.populationSize, group.selection.c_str(),
+                group.perSiteMutationRate, group.game.c_str(), group.runs, group.bestMean, group.bestGeneration, group.bestRun.c_str(),
+                group.finalMean.mean(), group.finalMax.mean(), sqrt(group.finalMax.variance()), group.generations.mean(),
+                group.evaluationsPerSecond.mean(), hitRate);
+    }
+    
+    fclose(out);
+    
+    cout << "aggregated " << runs << " run(s) into " << groups.size() << " configuration(s) in " << outFilename << endl;
+    
+    return true;
+}
@@ -0,0 +1,116 @@
+/*
+ * tMetrics.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tMetrics_h_included_
+#define _tMetrics_h_included_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include <string>
+#include "tProfile.h"
+
+using namespace std;
+
+#define     metricsVersion      4
+
+// running count, mean, variance, minimum and maximum of a stream of values
+// (Welford's method), so nothing has to be stored to summarize a population
+class tAccumulator
+{
+public:
+    tAccumulator();
+    void reset(void);
+    void add(double value);
+    double mean(void) const;
+    double variance(void) const;
+
+    uint64_t count;
+    double minimum, maximum;
+
+private:
+    double runningMean, sumSqDist;
+};
+
+// identifies the run at the start of a metrics file
+struct tMetricsHeader
+{
+    char magic[8];
+    uint32_t version, headerSize, recordSize, seed;
+    int32_t populationSize, totalGenerations;
+    double perSiteMutationRate;
+    char selection[32];
+
+    // added in version 4: the game parameters (tConfig::gameParameters), cut
+    // short if need be, and a hash of all of them
+    uint64_t gameHash;
+    char game[184];
+};
+
+// size of a version 3 header, the smallest header aggregateMetrics reads
+#define     metricsHeaderSizeV3 offsetof(tMetricsHeader, gameHash)
+
+// one generation. fitness is the classification fitness printed by edd;
+// the farm counts are zero without a farm, and the profile is zero without
+// -profile. fields are only ever added at the end.
+struct tMetricsRecord
+{
+    int32_t generation, populationSize;
+    double fitnessMin, fitnessMean, fitnessMax, fitnessVariance;
+    double genomeMin, genomeMean, genomeMax, genomeVariance;
+    double gatesMin, gatesMean, gatesMax, gatesVariance;
+    double evaluationsPerSecond, generationSeconds;
+    uint64_t farmEvaluations, farmCacheHits;
+
+    // added in version 2
+    double phaseSeconds[profilePhases];
+    uint64_t profileCounts[profileCounters];
+
+    // added in version 3; zero unless -perf could open the hardware counters
+    uint64_t phaseEvents[profilePhases][profileEvents];
+};
+
+// size of a version 1 record, the smallest record aggregateMetrics reads
+#define     metricsRecordSizeV1 offsetof(tMetricsRecord, phaseSeconds)
+
+class tMetricsLog
+{
+public:
+    tMetricsLog();
+    ~tMetricsLog();
+    bool open(const char *filename, const tMetricsHeader &header, int firstGeneration);
+    void write(const tMetricsRecord &record);
+    void close(void);
+
+    static void setupHeader(tMetricsHeader &header);
+    static void setGame(tMetricsHeader &header, const string &parameters);
+    static void fillRecord(tMetricsRecord &record, const tAccumulator &fitness, const tAccumulator &genome, const tAccumulator &gates);
+    static void fillProfile(tMetricsRecord &record, const tProfileData &profile);
+
+private:
+    FILE *file;
+};
+
+// summarizes many metrics files, grouped by configuration, into a csv file
+bool aggregateMetrics(const char *outFilename, const vector<string> &metricsFiles);
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * tNative.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tNative.h"
+#include "tAgent.h"
+#include "tLogic.h"
+#include "globalConst.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <iostream>
+
+typedef uint64_t (*tNativeStep)(uint64_t);
+
+// step functions already loaded by this process, by phenotype hash. the lock
+// only guards the map; brains are compiled and loaded outside of it.
+static mutex nativeLock;
+static map<unsigned long long, tNativeStep> nativeSteps;
+
+// numbers the builds of this process, so threads building at the same time
+// use different temporary files
+static atomic<unsigned> nativeBuilds(0);
+
+// eddStep(states) returns the next states. every product is a mask-and-compare
+// on the packed states, and each node ORs its products together.
+bool writeNativeSource(const tLogicNetwork &network, const char *filename)
+{
+    FILE *f = fopen(filename, "w");
+    
+    if (f == NULL)
+    {
+        perror(filename);
+        return false;
+    }
+    
+    fprintf(f, "/* generated by edd for phenotype %016llx: %d gates minimized to %d products */\n\n", network.phenotype,
+            network.gates, (int)network.cubes.size());
+    fprintf(f, "#include <stdint.h>\n\n");
+    fprintf(f, "uint64_t eddStep(uint64_t s)\n{\n    uint64_t n = 0;\n\n");
+    
+    for (int node = 0; node < network.nodes.size(); ++node)
+    {
+        fprintf(f, "    /* %s */\n    n |= (uint64_t)(", logicNodeName(network.nodes[node]).c_str());
+        
+        for (int cube = network.firstCube[node]; cube < network.firstCube[node + 1]; ++cube)
+        {
+            if (cube > network.firstCube[node])
+            {
+                fprintf(f, "\n        | ");
+            }
+            
+            if (network.cubes[cube].mask == 0)
+            {
+                fprintf(f, "1");
+            }
+            else
+            {
+                fprintf(f, "(((s ^ 0x%016llxULL) & 0x%016llxULL) == 0)", (unsigned long long)network.cubes[cube].value,
+                        (unsigned long long)network.cubes[cube].mask);
+            }
+        }
+        
+        fprintf(f, ") << %d;\n\n", network.nodes[node]);
+    }
+    
+    fprintf(f, "    return n;\n}\n");
+    
+    return fclose(f) == 0;
+}
+
+// compiles source into sharedObject under temporary names, so other edd
+// processes and threads sharing the cache never load a half-written file
+static bool buildSharedObject(const string &source, const string &sharedObject, const string &build)
+{
+    const char *compiler = getenv("CC");
+    string temporary = sharedObject + "." + build;
+    string command = string((compiler != NULL && compiler[0] != '\0') ? compiler : "cc") + " -O2 -shared -fPIC -o '" +
+                     temporary + "' '" + source + "'";
+    
+    if (system(command.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+        return false;
+    }
+    
+    if (rename(temporary.c_str(), sharedObject.c_str()) != 0)
+    {
+        unlink(temporary.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+bool compileNative(tAgent *agent, const string &cacheDirectory)
+{
+    if (agent->logicNetwork == NULL && !agent->compileLogic())
+    {
+        return false;
+    }
+    
+    tLogicNetwork *network = agent->logicNetwork;
+    
+    {
+        lock_guard<mutex> lock(nativeLock);
+        map<unsigned long long, tNativeStep>::iterator found = nativeSteps.find(network->phenotype);
+        
+        if (found != nativeSteps.end())
+        {
+            network->native = found->second;
+            return true;
+        }
+    }
+    
+    // file names are quoted for the shell
+    if (cacheDirectory.find('\'') != string::npos)
+    {
+        cerr << "native code cache directory must not contain quotes: " << cacheDirectory << endl;
+        return false;
+    }
+    
+    if (mkdir(cacheDirectory.c_str(), 0755) != 0 && errno != EEXIST)
+    {
+        perror(cacheDirectory.c_str());
+        return false;
+    }
+    
+    char name[64];
+    snprintf(name, sizeof(name), "/brain-%016llx", network->phenotype);
+    string base = cacheDirectory + name;
+    string sharedObject = base + ".so";
+    
+    if (access(sharedObject.c_str(), R_OK) != 0)
+    {
+        string build = to_string((long long)getpid()) + "-" + to_string((long long)nativeBuilds++);
+        string source = base + "." + build + ".c";
+        bool built = writeNativeSource(*network, source.c_str()) && buildSharedObject(source, sharedObject, build);
+        unlink(source.c_str());
+        
+        if (!built)
+        {
+            cerr << "could not compile native code for phenotype " << name + 7 << "; using the logic network" << endl;
+            return false;
+        }
+    }
+    
+    void *library = dlopen(sharedObject.c_str(), RTLD_NOW | RTLD_LOCAL);
+    tNativeStep step = (library != NULL) ? (tNativeStep)dlsym(library, "eddStep") : NULL;
+    
+    if (step == NULL)
+    {
+        const char *error = dlerror();
+        cerr << "could not load " << sharedObject << ": " << ((error != NULL) ? error : "no eddStep") << "; using the logic network" << endl;
+        
+        if (library != NULL)
+        {
+            dlclose(library);
+        }
+        
+        return false;
+    }
+    
+    // the library stays loaded for the rest of the process. a thread that
+    // loaded the same phenotype first has already put it in the map.
+    lock_guard<mutex> lock(nativeLock);
+    network->native = nativeSteps.insert(make_pair(network->phenotype, step)).first->second;
+    
+    return true;
+}
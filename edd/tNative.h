@@ -0,0 +1,41 @@
+/*
+ * tNative.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tNative_h_included_
+#define _tNative_h_included_
+
+#include <string>
+
+using namespace std;
+
+class tAgent;
+class tLogicNetwork;
+
+// ahead-of-time compilation of a deterministic brain: its minimized logic is
+// written out as straight-line C, compiled into a shared object by the system
+// compiler ($CC, or cc) and loaded as the brain's step function. shared
+// objects are kept in the cache directory under the brain's phenotype hash,
+// so a brain is only ever compiled once. if anything fails, the brain keeps
+// running on its logic network.
+bool    compileNative(tAgent *agent, const string &cacheDirectory);
+bool    writeNativeSource(const tLogicNetwork &network, const char *filename);
+
+#endif
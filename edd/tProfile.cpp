@@ -0,0 +1,350 @@
+/*
+ * tProfile.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tProfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <chrono>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char *phaseNames[profilePhases] =
+{
+    "generation", "evaluation", "phenotype", "steps", "sensing", "brain",
+    "statistics", "selection", "inherit", "shuffle", "output"
+};
+
+static const char *eventNames[profileEvents] =
+{
+    "cycles", "instructions", "L1d misses", "branch misses"
+};
+
+#ifdef EDD_PROFILE
+
+thread_local bool profileEnabled = false, profileHardware = false;
+thread_local tProfileData profileData;
+
+#ifdef __linux__
+
+// this thread's hardware counters. a counter that could not be opened stays
+// at zero. counters are read with rdpmc when the kernel allows it, which
+// costs a few cycles, and with a read() system call otherwise.
+static thread_local int eventFiles[profileEvents] = { -1, -1, -1, -1 };
+static thread_local perf_event_mmap_page *eventPages[profileEvents];
+
+static uint64_t readEvent(int event)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    perf_event_mmap_page *page = eventPages[event];
+    
+    if (page != NULL && page->cap_user_rdpmc)
+    {
+        uint32_t sequence;
+        uint64_t count;
+        
+        do
+        {
+            sequence = page->lock;
+            __sync_synchronize();
+            uint32_t index = page->index;
+            count = page->offset;
+            
+            if (index != 0)
+            {
+                // the counter is pmc_width bits wide; sign-extend it
+                int64_t pmc = __rdpmc(index - 1);
+                pmc <<= 64 - page->pmc_width;
+                pmc >>= 64 - page->pmc_width;
+                count += pmc;
+            }
+            
+            __sync_synchronize();
+        }
+        while (page->lock != sequence);
+        
+        return count;
+    }
+#endif
+    
+    uint64_t count = 0;
+    
+    if (eventFiles[event] < 0 || read(eventFiles[event], &count, sizeof(count)) != sizeof(count))
+    {
+        return 0;
+    }
+    
+    return count;
+}
+
+void profileReadEvents(uint64_t *events)
+{
+    for (int event = 0; event < profileEvents; ++event)
+    {
+        events[event] = readEvent(event);
+    }
+}
+
+// opens the calling thread's counters, user space only. returns false,
+// without complaint, if none of them can be opened (no PMU, a virtual
+// machine, perf_event_paranoid...), so -perf falls back to plain -profile.
+bool profileStartHardware(void)
+{
+    static const uint32_t types[profileEvents] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+    static const uint64_t configs[profileEvents] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    
+    bool opened = false;
+    
+    for (int event = 0; event < profileEvents; ++event)
+    {
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = types[event];
+        attributes.config = configs[event];
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        
+        eventFiles[event] = (int)syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+        eventPages[event] = NULL;
+        
+        if (eventFiles[event] < 0)
+        {
+            continue;
+        }
+        
+        void *page = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, eventFiles[event], 0);
+        eventPages[event] = (page == MAP_FAILED) ? NULL : (perf_event_mmap_page *)page;
+        opened = true;
+    }
+    
+    profileHardware = opened;
+    return opened;
+}
+
+static void stopHardware(void)
+{
+    profileHardware = false;
+    
+    for (int event = 0; event < profileEvents; ++event)
+    {
+        if (eventPages[event] != NULL)
+        {
+            munmap(eventPages[event], sysconf(_SC_PAGESIZE));
+            eventPages[event] = NULL;
+        }
+        
+        if (eventFiles[event] >= 0)
+        {
+            close(eventFiles[event]);
+            eventFiles[event] = -1;
+        }
+    }
+}
+
+#else
+
+void profileReadEvents(uint64_t *events)
+{
+    memset(events, 0, profileEvents * sizeof(uint64_t));
+}
+
+bool profileStartHardware(void)
+{
+    return false;
+}
+
+static void stopHardware(void) { }
+
+#endif
+
+// ticks and wall time when profiling started on this thread, to convert
+// ticks to seconds
+static thread_local uint64_t startTicks = 0;
+static thread_local chrono::steady_clock::time_point startTime;
+
+// counts every allocation made by a thread that is being profiled
+void *operator new(size_t size)
+{
+    if (profileEnabled)
+    {
+        ++profileData.counts[counterAllocations];
+    }
+    
+    void *memory = malloc(size == 0 ? 1 : size);
+    
+    if (memory == NULL)
+    {
+        throw bad_alloc();
+    }
+    
+    return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+    free(memory);
+}
+
+bool profileAvailable(void)
+{
+    return true;
+}
+
+void profileStart(void)
+{
+    memset(&profileData, 0, sizeof(profileData));
+    startTicks = profileTicks();
+    startTime = chrono::steady_clock::now();
+    profileEnabled = true;
+}
+
+void profileStop(void)
+{
+    profileEnabled = false;
+    stopHardware();
+}
+
+void profileSnapshot(tProfileData &data)
+{
+    data = profileData;
+}
+
+double profileSeconds(uint64_t ticks)
+{
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    uint64_t elapsed = profileTicks() - startTicks;
+    
+    return (elapsed == 0) ? 0.0 : ticks * (seconds / (double)elapsed);
+}
+
+#else
+
+bool profileAvailable(void)
+{
+    return false;
+}
+
+void profileStart(void) { }
+
+void profileStop(void) { }
+
+bool profileStartHardware(void)
+{
+    return false;
+}
+
+void profileSnapshot(tProfileData &data)
+{
+    memset(&data, 0, sizeof(data));
+}
+
+double profileSeconds(uint64_t ticks)
+{
+    return 0.0;
+}
+
+#endif
+
+void profileDifference(const tProfileData &later, const tProfileData &earlier, tProfileData &difference)
+{
+    for (int phase = 0; phase < profilePhases; ++phase)
+    {
+        difference.ticks[phase] = later.ticks[phase] - earlier.ticks[phase];
+        difference.calls[phase] = later.calls[phase] - earlier.calls[phase];
+    }
+    
+    for (int counter = 0; counter < profileCounters; ++counter)
+    {
+        difference.counts[counter] = later.counts[counter] - earlier.counts[counter];
+    }
+    
+    for (int phase = 0; phase < profilePhases; ++phase)
+    {
+        for (int event = 0; event < profileEvents; ++event)
+        {
+            difference.events[phase][event] = later.events[phase][event] - earlier.events[phase][event];
+        }
+    }
+}
+
+// prints each phase's time, number of calls and share of the generation time
+void profileReport(ostream &out, const tProfileData &data, const char *title)
+{
+    double total = profileSeconds(data.ticks[phaseGeneration]);
+    char line[128];
+    
+    out << "profile (" << title << "): " << total << " s" << endl;
+    snprintf(line, sizeof(line), "  %-12s %12s %14s %8s", "phase", "seconds", "calls", "%");
+    out << line << endl;
+    
+    for (int phase = 0; phase < profilePhases; ++phase)
+    {
+        double seconds = profileSeconds(data.ticks[phase]);
+        snprintf(line, sizeof(line), "  %-12s %12.4f %14llu %7.1f%%", phaseNames[phase], seconds,
+                 (unsigned long long)data.calls[phase], (total > 0.0) ? 100.0 * seconds / total : 0.0);
+        out << line << endl;
+    }
+    
+    out << "  games " << data.counts[counterGames] << ", brain steps " << data.counts[counterBrainSteps]
+        << ", gate updates " << data.counts[counterGateUpdates] << ", allocations " << data.counts[counterAllocations] << endl;
+    
+    // hardware counters, if -perf could open any
+    bool events = false;
+    
+    for (int phase = 0; phase < profilePhases; ++phase)
+    {
+        for (int event = 0; event < profileEvents; ++event)
+        {
+            events = events || (data.events[phase][event] != 0);
+        }
+    }
+    
+    if (!events)
+    {
+        return;
+    }
+    
+    snprintf(line, sizeof(line), "  %-12s %14s %14s %6s %14s %14s", "phase", eventNames[eventCycles], eventNames[eventInstructions], "IPC",
+             eventNames[eventL1Misses], eventNames[eventBranchMisses]);
+    out << line << endl;
+    
+    for (int phase = 0; phase < profilePhases; ++phase)
+    {
+        const uint64_t *counts = data.events[phase];
+        snprintf(line, sizeof(line), "  %-12s %14llu %14llu %6.2f %14llu %14llu", phaseNames[phase], (unsigned long long)counts[eventCycles],
+                 (unsigned long long)counts[eventInstructions], (counts[eventCycles] > 0) ? counts[eventInstructions] / (double)counts[eventCycles] : 0.0,
+                 (unsigned long long)counts[eventL1Misses], (unsigned long long)counts[eventBranchMisses]);
+        out << line << endl;
+    }
+}
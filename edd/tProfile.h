@@ -0,0 +1,176 @@
+/*
+ * tProfile.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tProfile_h_included_
+#define _tProfile_h_included_
+
+#include <stdint.h>
+#include <iostream>
+
+using namespace std;
+
+// phases of a generation. they nest (e.g. brain is part of steps, which is
+// part of evaluation), so their times are inclusive.
+enum tProfilePhase
+{
+    phaseGeneration,
+    phaseEvaluation,
+    phasePhenotype,
+    phaseSteps,
+    phaseSensing,
+    phaseBrain,
+    phaseStatistics,
+    phaseSelection,
+    phaseInherit,
+    phaseShuffle,
+    phaseOutput,
+    profilePhases
+};
+
+enum tProfileCounter
+{
+    counterGames,
+    counterBrainSteps,
+    counterGateUpdates,
+    counterAllocations,
+    profileCounters
+};
+
+// hardware performance counters, counted per phase with -perf
+enum tProfileEvent
+{
+    eventCycles,
+    eventInstructions,
+    eventL1Misses,
+    eventBranchMisses,
+    profileEvents
+};
+
+struct tProfileData
+{
+    uint64_t ticks[profilePhases], calls[profilePhases];
+    uint64_t counts[profileCounters];
+    uint64_t events[profilePhases][profileEvents];
+};
+
+// the timers only exist in builds with -DEDD_PROFILE; otherwise the macros
+// below expand to nothing and -profile only prints a warning
+#ifdef EDD_PROFILE
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+extern thread_local bool profileEnabled, profileHardware;
+extern thread_local tProfileData profileData;
+
+// where a phase began: its tick and, with hardware counters, their values
+struct tProfileMark
+{
+    uint64_t ticks;
+    uint64_t events[profileEvents];
+};
+
+void profileReadEvents(uint64_t *events);
+
+static inline uint64_t profileTicks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+static inline void profileBegin(tProfileMark &begin)
+{
+    if (profileEnabled)
+    {
+        if (profileHardware)
+        {
+            profileReadEvents(begin.events);
+        }
+        
+        begin.ticks = profileTicks();
+    }
+}
+
+static inline void profileEnd(int phase, const tProfileMark &begin)
+{
+    if (profileEnabled)
+    {
+        profileData.ticks[phase] += profileTicks() - begin.ticks;
+        ++profileData.calls[phase];
+        
+        if (profileHardware)
+        {
+            uint64_t events[profileEvents];
+            profileReadEvents(events);
+            
+            for (int event = 0; event < profileEvents; ++event)
+            {
+                profileData.events[phase][event] += events[event] - begin.events[event];
+            }
+        }
+    }
+}
+
+// times the rest of the enclosing scope
+class tProfileTimer
+{
+public:
+    tProfileTimer(int phase) : phase(phase) { profileBegin(begin); }
+    ~tProfileTimer() { profileEnd(phase, begin); }
+
+private:
+    int phase;
+    tProfileMark begin;
+};
+
+#define PROFILE_JOIN2(a, b)         a##b
+#define PROFILE_JOIN(a, b)          PROFILE_JOIN2(a, b)
+#define PROFILE_SCOPE(phase)        tProfileTimer PROFILE_JOIN(profileTimer, __LINE__)(phase)
+#define PROFILE_BEGIN(phase)        tProfileMark PROFILE_JOIN(profileBegin, phase); profileBegin(PROFILE_JOIN(profileBegin, phase))
+#define PROFILE_END(phase)          profileEnd(phase, PROFILE_JOIN(profileBegin, phase))
+#define PROFILE_COUNT(counter, n)   do { if (profileEnabled) profileData.counts[counter] += (n); } while (0)
+
+#else
+
+#define PROFILE_SCOPE(phase)
+#define PROFILE_BEGIN(phase)
+#define PROFILE_END(phase)
+#define PROFILE_COUNT(counter, n)
+
+#endif
+
+// these work in every build; without EDD_PROFILE the data stays zero
+bool    profileAvailable(void);
+void    profileStart(void);
+void    profileStop(void);
+bool    profileStartHardware(void);
+void    profileSnapshot(tProfileData &data);
+void    profileDifference(const tProfileData &later, const tProfileData &earlier, tProfileData &difference);
+double  profileSeconds(uint64_t ticks);
+void    profileReport(ostream &out, const tProfileData &data, const char *title);
+
+#endif
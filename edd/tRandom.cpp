@@ -0,0 +1,115 @@
+/*
+ * tRandom.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tRandom.h"
+
+// degree and separation of the trinomial x^31 + x^3 + 1 (glibc's TYPE_3)
+#define     randomDegree        31
+#define     randomSeparation    3
+
+// each thread has its own generator, so runs on different threads of a sweep
+// stay independent and reproducible
+static thread_local tRandomState randomState;
+static thread_local bool randomSeeded = false;
+
+void eddSrand(unsigned int seed)
+{
+    if (seed == 0)
+    {
+        seed = 1;
+    }
+
+    randomState.table[0] = seed;
+
+    // table[i] = (16807 * table[i - 1]) % 2147483647 without overflowing 31 bits
+    long long word = seed;
+
+    for (int i = 1; i < randomDegree; ++i)
+    {
+        long long hi = word / 127773;
+        long long lo = word % 127773;
+        word = 16807 * lo - 2836 * hi;
+
+        if (word < 0)
+        {
+            word += 2147483647;
+        }
+
+        randomState.table[i] = (int32_t)word;
+    }
+
+    randomState.front = randomSeparation;
+    randomState.rear = 0;
+    randomSeeded = true;
+
+    // throw away the first outputs, which are poorly mixed
+    for (int i = 0; i < randomDegree * 10; ++i)
+    {
+        eddRand();
+    }
+}
+
+int eddRand(void)
+{
+    if (!randomSeeded)
+    {
+        eddSrand(1);
+    }
+
+    uint32_t value = (uint32_t)randomState.table[randomState.front] + (uint32_t)randomState.table[randomState.rear];
+    randomState.table[randomState.front] = (int32_t)value;
+
+    if (++randomState.front >= randomDegree)
+    {
+        randomState.front = 0;
+        ++randomState.rear;
+    }
+    else if (++randomState.rear >= randomDegree)
+    {
+        randomState.rear = 0;
+    }
+
+    return (int)(value >> 1);
+}
+
+void eddGetRandomState(tRandomState &state)
+{
+    if (!randomSeeded)
+    {
+        eddSrand(1);
+    }
+
+    state = randomState;
+}
+
+void eddSetRandomState(const tRandomState &state)
+{
+    randomState = state;
+    randomSeeded = true;
+}
+
+uint64_t eddMixBits(uint64_t x)
+{
+    // splitmix64's finalizer
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
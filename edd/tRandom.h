@@ -0,0 +1,52 @@
+/*
+ * tRandom.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tRandom_h_included_
+#define _tRandom_h_included_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// complete state of the random number generator. it is the same additive
+// feedback generator glibc uses for rand(), so a given seed produces the same
+// runs as before, but its state can be saved and restored.
+struct tRandomState
+{
+    int32_t table[31];
+    int32_t front, rear;
+};
+
+void    eddSrand(unsigned int seed);
+int     eddRand(void);
+void    eddGetRandomState(tRandomState &state);
+void    eddSetRandomState(const tRandomState &state);
+
+// a well-mixed hash of x, for random choices that must depend only on their
+// inputs rather than on the generator's state
+uint64_t eddMixBits(uint64_t x);
+
+// generator for random_shuffle, equivalent to its default use of rand()
+struct tRandomShuffle
+{
+    ptrdiff_t operator()(ptrdiff_t n) { return eddRand() % n; }
+};
+
+#endif
@@ -0,0 +1,496 @@
+/*
+ * tReference.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tReference.h"
+#include "tRandom.h"
+#include "tDataset.h"
+#include "tAugment.h"
+#include "tGame.h"
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+
+// enough for the widest plain camera, 15x15 with 256 nodes
+#define referenceSensors            (15 * 15)
+
+// the 5x5 digits, indexed [digit][y][x] from the bottom row up
+static const int referenceGlyphs[10][5][5] =
+{
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    { {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 1, 0, 0} },
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 0, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    { {0, 1, 1, 1, 0}, {0, 0, 0, 1, 0}, {0, 0, 1, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    { {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 0, 1, 0} },
+    { {0, 1, 1, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 0, 0}, {0, 1, 1, 1, 0} },
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 0, 0}, {0, 1, 0, 0, 0} },
+    { {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    { {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0} },
+    { {0, 0, 0, 1, 0}, {0, 0, 0, 1, 0}, {0, 1, 1, 1, 0}, {0, 1, 0, 1, 0}, {0, 1, 1, 1, 0} }
+};
+
+void tReferenceGate::setup(const vector<unsigned char> &genome, int start)
+{
+    int k = (start + 2) % (int)genome.size();
+    
+    int xDim = 1 + (genome[(k++) % genome.size()] & 3);
+    int yDim = 1 + (genome[(k++) % genome.size()] & 3);
+    
+    // feedback nodes and levels are read but unused by deterministic gates
+    k += 4;
+    
+    ins.resize(yDim);
+    outs.resize(xDim);
+    
+    for (int i = 0; i < yDim; ++i)
+    {
+        ins[i] = genome[(k + i) % genome.size()] & (brainNodes - 1);
+    }
+    
+    for (int i = 0; i < xDim; ++i)
+    {
+        outs[i] = genome[(k + 4 + i) % genome.size()] & (brainNodes - 1);
+    }
+    
+    k = k + 16;
+    hmm.resize(1 << yDim);
+    sums.resize(1 << yDim);
+    
+    for (int i = 0; i < (1 << yDim); ++i)
+    {
+        hmm[i].resize(1 << xDim);
+        int largestValueInRow = 0, largestValueInRowIndex = 0;
+        
+        for (int j = 0; j < (1 << xDim); ++j)
+        {
+            hmm[i][j] = 0;
+            
+            if (genome[(k + j + ((1 << xDim) * i)) % genome.size()] > largestValueInRow)
+            {
+                largestValueInRow = genome[(k + j + ((1 << xDim) * i)) % genome.size()];
+                largestValueInRowIndex = j;
+            }
+        }
+        
+        hmm[i][largestValueInRowIndex] = 255;
+        sums[i] = 255;
+    }
+}
+
+void tReferenceGate::update(unsigned char *states, unsigned char *newStates)
+{
+    int I = 0;
+    
+    for (int i = 0; i < ins.size(); ++i)
+    {
+        I = (I << 1) + ((states[ins[i]]) & 1);
+    }
+    
+    int r = 1 + (eddRand() % (sums[I] - 1));
+    int j = 0;
+    
+    while (r > hmm[I][j])
+    {
+        r -= hmm[I][j];
+        ++j;
+    }
+    
+    for (int i = 0; i < outs.size(); ++i)
+    {
+        newStates[outs[i]] |= (j >> i) & 1;
+    }
+}
+
+void tReferenceBrain::setup(const vector<unsigned char> &genome)
+{
+    gates.clear();
+    
+    for (int i = 0; i < genome.size(); ++i)
+    {
+        if ((genome[i] == 42) && (genome[(i + 1) % genome.size()] == (255 - 42)))
+        {
+            gates.push_back(tReferenceGate());
+            gates.back().setup(genome, i);
+        }
+    }
+    
+    reset();
+    
+    for (int i = 0; i < brainNodes; ++i)
+    {
+        newStates[i] = 0;
+    }
+}
+
+void tReferenceBrain::reset(void)
+{
+    for (int i = 0; i < brainNodes; ++i)
+    {
+        states[i] = 0;
+    }
+}
+
+void tReferenceBrain::update(void)
+{
+    for (int i = 0; i < gates.size(); ++i)
+    {
+        gates[i].update(states, newStates);
+    }
+    
+    for (int i = 0; i < brainNodes; ++i)
+    {
+        states[i] = newStates[i];
+        newStates[i] = 0;
+    }
+}
+
+void referenceExecuteGame(const vector<unsigned char> &genome, int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement,
+                          bool noise, float noiseAmount, int totalSteps, bool readyActuator, double speedBonus,
+                          const tDataset *dataset, const vector<uint32_t> *batch, bool augment, int retinaPooling,
+                          int retinaSize, tReferenceResult &result, vector<unsigned char> *stateTrace)
+{
+    // sensors are numbered in a square spiral out from the center of the camera
+    int sensorOffsetX[referenceSensors], sensorOffsetY[referenceSensors];
+    int offsetX = 0, offsetY = 0, offsetAmount = 0;
+    
+    for (int sensor = 0; sensor < referenceSensors; ++sensor)
+    {
+        int root = sqrt(sensor);
+        
+        if (root % 2 == 1 && root * root == sensor)
+        {
+            ++offsetAmount;
+            offsetX = -offsetAmount;
+            offsetY = -offsetAmount;
+        }
+        else if (offsetX != offsetAmount && offsetY == -offsetAmount)
+        {
+            ++offsetX;
+        }
+        else if (offsetX == offsetAmount && offsetY != offsetAmount)
+        {
+            ++offsetY;
+        }
+        else if (offsetX != -offsetAmount && offsetY == offsetAmount)
+        {
+            --offsetX;
+        }
+        else if (offsetX == -offsetAmount && offsetY != -offsetAmount)
+        {
+            --offsetY;
+        }
+        
+        sensorOffsetX[sensor] = offsetX;
+        sensorOffsetY[sensor] = offsetY;
+    }
+    
+    // place the digits, one per trial, in random spots if asked to, as random
+    // images from the dataset if there is one, or as the images of the batch
+    int trials = (batch != NULL) ? (int)batch->size() : 10;
+    vector< vector< vector<int> > > digitGrid(trials, vector< vector<int> >(gridSizeX, vector<int>(gridSizeY, 0)));
+    vector<int> trialDigits(trials);
+    int digitWidth = (dataset != NULL) ? dataset->width() : 5;
+    int digitHeight = (dataset != NULL) ? dataset->height() : 5;
+    
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        int digit = (batch != NULL) ? dataset->label((*batch)[trial]) : trial;
+        int digitCenterX = (int)(gridSizeX / 2.0), digitCenterY = (int)(gridSizeY / 2.0);
+        
+        if (randomPlacement && dataset != NULL)
+        {
+            digitCenterX = digitWidth / 2 + eddRand() % (gridSizeX - digitWidth + 1);
+            digitCenterY = digitHeight / 2 + eddRand() % (gridSizeY - digitHeight + 1);
+        }
+        else if (randomPlacement)
+        {
+            bool validPlacement = false;
+            
+            while (!validPlacement)
+            {
+                digitCenterX = randDouble * gridSizeX;
+                digitCenterY = randDouble * gridSizeY;
+                
+                validPlacement = (digitCenterX - 2 >= 0 && digitCenterX + 2 < gridSizeX &&
+                                  digitCenterY - 2 >= 0 && digitCenterY + 2 < gridSizeY);
+            }
+        }
+        
+        int left = digitCenterX - digitWidth / 2, bottom = digitCenterY - digitHeight / 2;
+        
+        trialDigits[trial] = digit;
+        
+        // the digit's pixels, indexed [x][y] with y = 0 its top row
+        vector< vector<int> > pixels(digitWidth, vector<int>(digitHeight, 0));
+        
+        if (dataset != NULL)
+        {
+            int image = (batch != NULL) ? (*batch)[trial] : dataset->imagesOf(digit)[eddRand() % dataset->imagesOf(digit).size()];
+            
+            for (int y = 0; y < digitHeight; ++y)
+            {
+                for (int x = 0; x < digitWidth; ++x)
+                {
+                    pixels[x][y] = dataset->pixel(image, x, y);
+                }
+            }
+        }
+        else
+        {
+            for (int y = 0; y < 5; ++y)
+            {
+                for (int x = 0; x < 5; ++x)
+                {
+                    pixels[x][y] = referenceGlyphs[digit][4 - y][x];
+                }
+            }
+        }
+        
+        if (augment)
+        {
+            tAugmentation variant = augmentation(eddRand() % augmentVariants);
+            vector< vector<int> > stroked(pixels), shifted(pixels);
+            
+            // pixel (x, y), or 0 outside the digit
+            auto at = [&](const vector< vector<int> > &image, int x, int y)
+            {
+                return (x >= 0 && x < digitWidth && y >= 0 && y < digitHeight) ? image[x][y] : 0;
+            };
+            
+            for (int y = 0; y < digitHeight; ++y)
+            {
+                for (int x = 0; x < digitWidth; ++x)
+                {
+                    if (variant.stroke > 0)
+                    {
+                        stroked[x][y] = at(pixels, x, y) || at(pixels, x - 1, y) || at(pixels, x + 1, y) ||
+                                        at(pixels, x, y - 1) || at(pixels, x, y + 1);
+                    }
+                    else if (variant.stroke < 0)
+                    {
+                        bool rightEnd = at(pixels, x - 1, y) && !at(pixels, x + 1, y);
+                        bool bottomEnd = at(pixels, x, y - 1) && !at(pixels, x, y + 1);
+                        stroked[x][y] = at(pixels, x, y) && !rightEnd && !bottomEnd;
+                    }
+                }
+            }
+            
+            for (int y = 0; y < digitHeight; ++y)
+            {
+                for (int x = 0; x < digitWidth; ++x)
+                {
+                    shifted[x][y] = at(stroked, x - variant.shiftX, y - variant.shiftY);
+                    
+                    if ((augmentNoise(variant.noise, y, false) >> x) & 1)
+                    {
+                        shifted[x][y] = 0;
+                    }
+                    
+                    if ((augmentNoise(variant.noise, y, true) >> x) & 1)
+                    {
+                        shifted[x][y] = 1;
+                    }
+                }
+            }
+            
+            pixels = shifted;
+        }
+        
+        // the digit's rows run down the grid
+        for (int y = 0; y < digitHeight; ++y)
+        {
+            for (int x = 0; x < digitWidth; ++x)
+            {
+                digitGrid[trial][left + x][bottom + digitHeight - 1 - y] = pixels[x][y];
+            }
+        }
+    }
+    
+    tReferenceBrain brain;
+    brain.setup(genome);
+    result.classificationFitness = 0.0;
+    result.savedSteps = 0;
+    double speedFitness = 0.0;
+    
+    for (int digit = 0; digit < 10; ++digit)
+    {
+        result.truePositives[digit] = 0;
+        result.falsePositives[digit] = 0;
+        result.trueNegatives[digit] = 0;
+        result.falseNegatives[digit] = 0;
+    }
+    
+    // the trials are played in a random order
+    vector<int> order;
+    
+    for (int trial = 0; trial < trials; ++trial)
+    {
+        order.push_back(trial);
+    }
+    
+    random_shuffle(order.begin(), order.end(), tRandomShuffle());
+    
+    for (int counter = 0; counter < order.size(); ++counter)
+    {
+        int trial = order[counter];
+        int digit = trialDigits[trial];
+        
+        brain.reset();
+        int cameraX = gridSizeX / 2.0, cameraY = gridSizeY / 2.0;
+        int cameraSize = (retinaPooling != poolNone) ? max(3, retinaSize) : 3;
+        int stepsTaken = totalSteps;
+        
+        for (int step = 0; step < totalSteps; ++step)
+        {
+            for (int sensor = 0; sensor < min(pow(min(gridSizeX, gridSizeY), 2.0), (double)brainNodes); ++sensor)
+            {
+                brain.states[sensor] = 0;
+            }
+            
+            if (retinaPooling == poolNone)
+            {
+                for (int sensor = 0; sensor < min(cameraSize * cameraSize, brainNodes); ++sensor)
+                {
+                    int sensorX = cameraX + sensorOffsetX[sensor];
+                    int sensorY = cameraY + sensorOffsetY[sensor];
+                    
+                    if (sensorX >= 0 && sensorX < gridSizeX && sensorY >= 0 && sensorY < gridSizeY &&
+                        digitGrid[trial][sensorX][sensorY] == 1)
+                    {
+                        brain.states[sensor] = 1;
+                    }
+                }
+            }
+            else
+            {
+                // each sensor counts the pixels of its block of the camera's view
+                for (int sensor = 0; sensor < min(retinaSize * retinaSize, brainNodes); ++sensor)
+                {
+                    int column = sensorOffsetX[sensor] + retinaSize / 2, row = sensorOffsetY[sensor] + retinaSize / 2;
+                    int left = cameraX - cameraSize / 2 + column * cameraSize / retinaSize;
+                    int right = cameraX - cameraSize / 2 + (column + 1) * cameraSize / retinaSize;
+                    int bottom = cameraY - cameraSize / 2 + row * cameraSize / retinaSize;
+                    int top = cameraY - cameraSize / 2 + (row + 1) * cameraSize / retinaSize;
+                    int on = 0, pixels = 0;
+                    
+                    for (int x = left; x < right; ++x)
+                    {
+                        for (int y = bottom; y < top; ++y)
+                        {
+                            ++pixels;
+                            
+                            if (x >= 0 && x < gridSizeX && y >= 0 && y < gridSizeY && digitGrid[trial][x][y] == 1)
+                            {
+                                ++on;
+                            }
+                        }
+                    }
+                    
+                    brain.states[sensor] = (retinaPooling == poolAny) ? (on > 0) : (on * 2 > pixels);
+                }
+            }
+            
+            brain.update();
+            
+            if (stateTrace != NULL)
+            {
+                stateTrace->insert(stateTrace->end(), brain.states, brain.states + brainNodes);
+            }
+            
+            // the ready actuator ends the digit
+            if (readyActuator && (brain.states[(brainNodes - 27)] & 1))
+            {
+                stepsTaken = step + 1;
+                break;
+            }
+            
+            int moveUp = brain.states[(brainNodes - 1)] & 1;
+            int moveDown = brain.states[(brainNodes - 2)] & 1;
+            int moveLeft = brain.states[(brainNodes - 3)] & 1;
+            int moveRight = brain.states[(brainNodes - 4)] & 1;
+            int zoomIn = brain.states[(brainNodes - 5)] & 1;
+            int zoomOut = brain.states[(brainNodes - 6)] & 1;
+            
+            if (zoomingCamera && moveUp) cameraY += 1;
+            if (zoomingCamera && moveDown) cameraY -= 1;
+            if (zoomingCamera && moveRight) cameraX += 1;
+            if (zoomingCamera && moveLeft) cameraX -= 1;
+            
+            if (zoomingCamera && zoomIn && cameraSize > ((retinaPooling != poolNone) ? retinaSize : 1))
+            {
+                cameraSize -= 2;
+            }
+            
+            if (zoomingCamera && zoomOut && cameraSize + 2 <= gridSizeX &&
+                (cameraSize + 2 <= 9 || (cameraSize + 2) * (cameraSize + 2) <= brainNodes - 27 || retinaPooling != poolNone))
+            {
+                cameraSize += 2;
+            }
+        }
+        
+        result.savedSteps += totalSteps - stepsTaken;
+        
+        // score the classification and veto bits
+        float score = 0.0;
+        float numDigitsGuessed = 0.0;
+        
+        for (int i = 0; i < 10; ++i)
+        {
+            bool guessedThisDigit = ((brain.states[(brainNodes - 7 - i)] & 1) == 1 && (brain.states[(brainNodes - 17 - i)] & 1) == 0);
+            
+            if (guessedThisDigit)
+            {
+                numDigitsGuessed += 1.0;
+            }
+            
+            if (guessedThisDigit && i == digit)
+            {
+                result.truePositives[i] += 1;
+                score = 1.0;
+            }
+            else if (guessedThisDigit && i != digit)
+            {
+                result.falsePositives[i] += 1;
+            }
+            else if (!guessedThisDigit && i == digit)
+            {
+                result.falseNegatives[i] += 1;
+            }
+            else
+            {
+                result.trueNegatives[i] += 1;
+            }
+        }
+        
+        if (numDigitsGuessed > 0.0)
+        {
+            result.classificationFitness += score / numDigitsGuessed;
+            speedFitness += speedBonus * (score / numDigitsGuessed) * (totalSteps - stepsTaken) / totalSteps;
+        }
+    }
+    
+    result.fitness = (result.classificationFitness + speedFitness) / trials;
+    result.classificationFitness = result.classificationFitness / trials;
+    
+    if (result.fitness <= 0.0)
+    {
+        result.fitness = 0.000001;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * tReference.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tReference_h_included_
+#define _tReference_h_included_
+
+#include "globalConst.h"
+#include <stdint.h>
+#include <vector>
+
+using namespace std;
+
+class tDataset;
+
+// the brain and the game as they were before any fast paths were added, kept
+// as the reference that difftest checks the production engines against.
+// nothing here is used during evolution, and nothing here should be optimized.
+
+// a deterministic gate; tHMMU::setupDeterministic and tHMMU::update
+class tReferenceGate
+{
+public:
+    vector< vector<unsigned char> > hmm;
+    vector<unsigned int> sums;
+    vector<int> ins, outs;
+    
+    void setup(const vector<unsigned char> &genome, int start);
+    void update(unsigned char *states, unsigned char *newStates);
+};
+
+// a whole brain; tAgent::setupPhenotype, tAgent::resetBrain and tAgent::updateStates
+class tReferenceBrain
+{
+public:
+    vector<tReferenceGate> gates;
+    unsigned char states[maxNodes], newStates[maxNodes];
+    
+    void setup(const vector<unsigned char> &genome);
+    void reset(void);
+    void update(void);
+};
+
+// what a game leaves in the agent
+struct tReferenceResult
+{
+    double fitness, classificationFitness;
+    int truePositives[10], falsePositives[10];
+    int trueNegatives[10], falseNegatives[10];
+    int savedSteps;
+};
+
+// tGame::executeGame for the given genome, with tGame's totalSteps,
+// readyActuator, speedBonus, dataset, batch, retinaPooling and retinaSize, and
+// with augment, random variants of the digits as -augment shows them. if
+// stateTrace is given, the
+// brain's states are appended to it after every step.
+void referenceExecuteGame(const vector<unsigned char> &genome, int gridSizeX, int gridSizeY, bool zoomingCamera, bool randomPlacement,
+                          bool noise, float noiseAmount, int totalSteps, bool readyActuator, double speedBonus,
+                          const tDataset *dataset, const vector<uint32_t> *batch, bool augment, int retinaPooling,
+                          int retinaSize, tReferenceResult &result, vector<unsigned char> *stateTrace);
+
+#endif
@@ -0,0 +1,267 @@
+/*
+ * tSweep.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tSweep.h"
+#include "tConfig.h"
+#include "tEvolution.h"
+#include "tThreadPool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+
+// the parameter file has one run per line, written as the command-line
+// parameters of that run (e.g. "-p 200 -g 5000 -rl 4 -s 1"). blank lines and
+// lines starting with # are skipped. "-reps [int]" repeats a line with
+// consecutive seeds, starting from its -s (or 1). a line without -s gets a
+// time-based seed, a line without -e writes lod.csv and best.genome, and a
+// line without -metrics writes metrics.edm.
+static bool readSweepFile(const string &parameterFile, vector< vector<string> > &runs)
+{
+    ifstream file(parameterFile.c_str());
+    
+    if (!file.is_open())
+    {
+        cerr << "could not open sweep file " << parameterFile << endl;
+        return false;
+    }
+    
+    string line;
+    unsigned int timeSeed = (unsigned int)time(NULL);
+    
+    while (getline(file, line))
+    {
+        stringstream words(line);
+        vector<string> arguments;
+        string word;
+        int repetitions = 1;
+        bool hasSeed = false, hasOutput = false, hasMetrics = false;
+        unsigned int seed = 1;
+        
+        while (words >> word)
+        {
+            if (arguments.empty() && word[0] == '#')
+            {
+                break;
+            }
+            
+            if (word == "-reps" && words >> word)
+            {
+                repetitions = atoi(word.c_str());
+                continue;
+            }
+            
+            arguments.push_back(word);
+        }
+        
+        if (arguments.empty())
+        {
+            continue;
+        }
+        
+        for (int i = 0; i < arguments.size(); ++i)
+        {
+            if (arguments[i] == "-s" && (i + 1) < arguments.size())
+            {
+                hasSeed = true;
+                seed = atoi(arguments[i + 1].c_str());
+            }
+            else if (arguments[i] == "-e")
+            {
+                hasOutput = true;
+            }
+            else if (arguments[i] == "-metrics")
+            {
+                hasMetrics = true;
+            }
+        }
+        
+        if (!hasOutput)
+        {
+            arguments.push_back("-e");
+            arguments.push_back("lod.csv");
+            arguments.push_back("best.genome");
+        }
+        
+        if (!hasMetrics)
+        {
+            arguments.push_back("-metrics");
+            arguments.push_back("metrics.edm");
+        }
+        
+        for (int rep = 0; rep < repetitions; ++rep)
+        {
+            vector<string> run = arguments;
+            
+            // the last -s wins, so appending one overrides the line's own
+            if (repetitions > 1 || !hasSeed)
+            {
+                stringstream seedString;
+                seedString << ((repetitions > 1) ? seed + rep : timeSeed + (unsigned int)runs.size());
+                run.push_back("-s");
+                run.push_back(seedString.str());
+            }
+            
+            runs.push_back(run);
+        }
+    }
+    
+    return true;
+}
+
+static bool makeDirectory(const string &directory)
+{
+    if (mkdir(directory.c_str(), 0777) != 0 && errno != EEXIST)
+    {
+        perror(directory.c_str());
+        return false;
+    }
+    
+    return true;
+}
+
+bool runSweep(const string &parameterFile, const string &outputDirectory, int cores)
+{
+    vector< vector<string> > runs;
+    
+    if (!readSweepFile(parameterFile, runs) || !makeDirectory(outputDirectory))
+    {
+        return false;
+    }
+    
+    if (runs.empty())
+    {
+        cerr << "no runs in sweep file " << parameterFile << endl;
+        return false;
+    }
+    
+    int count = (int)runs.size();
+    vector<tConfig> configs(count);
+    vector<ofstream*> logs(count);
+    vector<tRunSummary> summaries(count);
+    vector<string> commandLines(count);
+    
+    // parse every run up front, so a bad line stops the sweep before it starts
+    for (int run = 0; run < count; ++run)
+    {
+        vector<char*> argv;
+        argv.push_back((char *)"edd");
+        
+        for (int i = 0; i < runs[run].size(); ++i)
+        {
+            argv.push_back((char *)runs[run][i].c_str());
+            commandLines[run] += (i > 0 ? " " : "") + runs[run][i];
+        }
+        
+        stringstream directory;
+        directory << outputDirectory << "/run-" << setw(4) << setfill('0') << run + 1;
+        
+        if (!makeDirectory(directory.str()))
+        {
+            return false;
+        }
+        
+        logs[run] = new ofstream((directory.str() + "/run.log").c_str());
+        *logs[run] << "arguments: " << commandLines[run] << endl;
+        
+        tConfig &config = configs[run];
+        config.parseArguments((int)argv.size(), &argv[0], *logs[run]);
+        config.outputDirectory = directory.str();
+        config.out = logs[run];
+        
+        if (config.display_only || config.display_directory || config.make_logic_table || config.make_dot_edd ||
+            config.worker_port > 0 || config.binary_genome_file != "" || config.sweep_file != "" || config.aggregate_file != "")
+        {
+            cerr << "sweep runs can only evolve: " << commandLines[run] << endl;
+            return false;
+        }
+    }
+    
+    cout << "running " << count << " run(s) on " << cores << " core(s)" << endl;
+    
+    mutex progressLock;
+    int finished = 0;
+    
+    {
+        tThreadPool pool(cores);
+        
+        for (int run = 0; run < count; ++run)
+        {
+            // a run with local worker processes also occupies their cores,
+            // so it waits until that many are free
+            pool.submit([&, run]()
+            {
+                summaries[run] = runEvolution(configs[run]);
+                logs[run]->close();
+                
+                lock_guard<mutex> guard(progressLock);
+                ++finished;
+                cout << "run " << run + 1 << " (" << finished << "/" << count << ") ";
+                
+                if (summaries[run].completed)
+                {
+                    cout << "finished in " << summaries[run].seconds << " s, max fitness " << summaries[run].finalMaxFitness << endl;
+                }
+                else
+                {
+                    cout << "failed" << endl;
+                }
+            }, 1 + configs[run].farm_local_workers);
+        }
+        
+        pool.wait();
+    }
+    
+    string summaryFileName = outputDirectory + "/summary.csv";
+    FILE *summary = fopen(summaryFileName.c_str(), "w");
+    
+    if (summary == NULL)
+    {
+        perror(summaryFileName.c_str());
+        return false;
+    }
+    
+    fprintf(summary, "run,completed,seed,population_size,generations,final_avg_fitness,final_max_fitness,best_max_fitness,best_generation,genome_size,gates,seconds,arguments\n");
+    
+    for (int run = 0; run < count; ++run)
+    {
+        tRunSummary &result = summaries[run];
+        
+        fprintf(summary, "%d,%d,%u,%d,%d,%f,%f,%f,%d,%d,%d,%.3f,\"%s\"\n", run + 1, result.completed ? 1 : 0, configs[run].randomSeed,
+                configs[run].populationSize, result.generations, result.finalAvgFitness, result.finalMaxFitness,
+                result.bestMaxFitness, result.bestGeneration, result.genomeSize, result.gates, result.seconds, commandLines[run].c_str());
+        
+        delete logs[run];
+    }
+    
+    fclose(summary);
+    
+    cout << "wrote " << summaryFileName << endl;
+    
+    return true;
+}
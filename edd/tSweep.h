@@ -0,0 +1,33 @@
+/*
+ * tSweep.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tSweep_h_included_
+#define _tSweep_h_included_
+
+#include <string>
+
+using namespace std;
+
+// runs every configuration in a parameter file on a pool of threads, each in
+// its own directory under outputDirectory, and writes summary.csv there
+bool runSweep(const string &parameterFile, const string &outputDirectory, int cores);
+
+#endif
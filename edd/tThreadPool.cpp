@@ -0,0 +1,109 @@
+/*
+ * tThreadPool.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tThreadPool.h"
+
+tThreadPool::tThreadPool(int cores)
+{
+    budget = (cores < 1) ? 1 : cores;
+    coresInUse = 0;
+    running = 0;
+    stopping = false;
+    
+    for (int i = 0; i < budget; ++i)
+    {
+        threads.push_back(thread(&tThreadPool::work, this));
+    }
+}
+
+tThreadPool::~tThreadPool()
+{
+    wait();
+    
+    {
+        unique_lock<mutex> guard(lock);
+        stopping = true;
+    }
+    
+    changed.notify_all();
+    
+    for (int i = 0; i < threads.size(); ++i)
+    {
+        threads[i].join();
+    }
+}
+
+// queues a task; a task needing more cores than the budget gets the whole budget
+void tThreadPool::submit(function<void()> task, int cores)
+{
+    tTask queued;
+    queued.run = task;
+    queued.cores = (cores < 1) ? 1 : ((cores > budget) ? budget : cores);
+    
+    {
+        unique_lock<mutex> guard(lock);
+        tasks.push_back(queued);
+    }
+    
+    changed.notify_all();
+}
+
+// blocks until every submitted task has finished
+void tThreadPool::wait(void)
+{
+    unique_lock<mutex> guard(lock);
+    
+    while (!tasks.empty() || running > 0)
+    {
+        changed.wait(guard);
+    }
+}
+
+void tThreadPool::work(void)
+{
+    unique_lock<mutex> guard(lock);
+    
+    while (true)
+    {
+        while (!stopping && (tasks.empty() || coresInUse + tasks.front().cores > budget))
+        {
+            changed.wait(guard);
+        }
+        
+        if (stopping)
+        {
+            return;
+        }
+        
+        tTask task = tasks.front();
+        tasks.pop_front();
+        coresInUse += task.cores;
+        ++running;
+        
+        guard.unlock();
+        task.run();
+        guard.lock();
+        
+        coresInUse -= task.cores;
+        --running;
+        changed.notify_all();
+    }
+}
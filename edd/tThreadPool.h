@@ -0,0 +1,62 @@
+/*
+ * tThreadPool.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tThreadPool_h_included_
+#define _tThreadPool_h_included_
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+using namespace std;
+
+// runs tasks on a fixed set of threads within a budget of cores. each task
+// says how many cores it occupies (e.g. a run with its own worker processes),
+// and tasks start in order once enough of the budget is free.
+class tThreadPool
+{
+public:
+    tThreadPool(int cores);
+    ~tThreadPool();
+    void submit(function<void()> task, int cores = 1);
+    void wait(void);
+
+private:
+    struct tTask
+    {
+        function<void()> run;
+        int cores;
+    };
+
+    void work(void);
+
+    vector<thread> threads;
+    deque<tTask> tasks;
+    mutex lock;
+    condition_variable changed;
+    int budget, coresInUse, running;
+    bool stopping;
+};
+
+#endif
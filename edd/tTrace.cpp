@@ -0,0 +1,239 @@
+/*
+ * tTrace.cpp
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tTrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define traceChunkEvents            16384
+
+atomic<bool> traceEnabled(false);
+
+struct tTraceEvent
+{
+    const char *name;
+    uint64_t nanoseconds;
+    char type;
+};
+
+// events are appended to fixed-size chunks. only the owning thread writes;
+// it publishes each event by advancing count, and each new chunk by setting
+// next, so the writer of the trace can read everything published so far.
+struct tTraceChunk
+{
+    tTraceEvent events[traceChunkEvents];
+    atomic<int> count;
+    atomic<tTraceChunk*> next;
+    
+    tTraceChunk() : count(0), next(NULL) { }
+};
+
+struct tTraceBuffer
+{
+    tTraceChunk *first, *last;
+    int thread;
+    string name;
+    bool named;
+};
+
+// every thread's buffer, registered on its first event. the registry and
+// the buffers live until the process ends.
+static mutex *traceLock = new mutex;
+static vector<tTraceBuffer*> *traceBuffers = new vector<tTraceBuffer*>;
+static thread_local tTraceBuffer *threadBuffer = NULL;
+
+static string traceFileName;
+static pid_t traceProcess = 0;
+static chrono::steady_clock::time_point traceStartTime;
+static volatile sig_atomic_t traceRequested = 0;
+
+static void requestTrace(int signal)
+{
+    traceRequested = 1;
+}
+
+static void writeTraceAtExit(void)
+{
+    if (traceEnabled && getpid() == traceProcess)
+    {
+        traceWrite();
+    }
+}
+
+static tTraceBuffer *registerThread(void)
+{
+    tTraceBuffer *buffer = new tTraceBuffer;
+    buffer->first = buffer->last = new tTraceChunk;
+    
+    lock_guard<mutex> lock(*traceLock);
+    buffer->thread = (int)traceBuffers->size() + 1;
+    buffer->name = (buffer->thread == 1) ? "main" : "thread " + to_string(buffer->thread);
+    buffer->named = false;
+    traceBuffers->push_back(buffer);
+    
+    return buffer;
+}
+
+void traceRecord(const char *name, char type)
+{
+    if (threadBuffer == NULL)
+    {
+        threadBuffer = registerThread();
+    }
+    
+    tTraceChunk *chunk = threadBuffer->last;
+    int count = chunk->count.load(memory_order_relaxed);
+    
+    if (count == traceChunkEvents)
+    {
+        tTraceChunk *next = new tTraceChunk;
+        chunk->next.store(next, memory_order_release);
+        threadBuffer->last = chunk = next;
+        count = 0;
+    }
+    
+    tTraceEvent &event = chunk->events[count];
+    event.name = name;
+    event.type = type;
+    event.nanoseconds = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - traceStartTime).count();
+    chunk->count.store(count + 1, memory_order_release);
+}
+
+// starts tracing every thread. the trace is written to fileName when the
+// process exits, and whenever SIGUSR2 is received (at the end of the
+// generation being evolved).
+void traceStart(const char *fileName)
+{
+    traceFileName = fileName;
+    traceProcess = getpid();
+    traceStartTime = chrono::steady_clock::now();
+    traceEnabled = true;
+    
+    signal(SIGUSR2, requestTrace);
+    atexit(writeTraceAtExit);
+}
+
+// names the calling thread in the trace, e.g. after the run it evolves
+void traceSetThreadName(const char *name)
+{
+    if (!traceEnabled)
+    {
+        return;
+    }
+    
+    if (threadBuffer == NULL)
+    {
+        threadBuffer = registerThread();
+    }
+    
+    // a pool thread that evolves several runs of a sweep lists all of them
+    lock_guard<mutex> lock(*traceLock);
+    threadBuffer->name = threadBuffer->named ? threadBuffer->name + ", " + name : string(name);
+    threadBuffer->named = true;
+}
+
+// writes the trace if SIGUSR2 asked for it. called between generations.
+void traceService(void)
+{
+    if (traceRequested && traceEnabled)
+    {
+        traceRequested = 0;
+        traceWrite();
+    }
+}
+
+static void writeString(FILE *file, const string &text)
+{
+    fputc('"', file);
+    
+    for (size_t i = 0; i < text.size(); ++i)
+    {
+        if (text[i] == '"' || text[i] == '\\')
+        {
+            fputc('\\', file);
+        }
+        
+        fputc((unsigned char)text[i] < 32 ? ' ' : text[i], file);
+    }
+    
+    fputc('"', file);
+}
+
+// writes every event recorded so far. the file is written under a temporary
+// name and renamed, so a viewer never sees half a trace.
+bool traceWrite(void)
+{
+    string temporaryName = traceFileName + ".tmp";
+    FILE *file = fopen(temporaryName.c_str(), "w");
+    
+    if (file == NULL)
+    {
+        perror(temporaryName.c_str());
+        return false;
+    }
+    
+    lock_guard<mutex> lock(*traceLock);
+    int process = (int)traceProcess;
+    bool first = true;
+    
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    
+    for (size_t b = 0; b < traceBuffers->size(); ++b)
+    {
+        tTraceBuffer *buffer = (*traceBuffers)[b];
+        
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":", first ? "" : ",\n", process, buffer->thread);
+        writeString(file, buffer->name);
+        fprintf(file, "}}");
+        first = false;
+        
+        for (tTraceChunk *chunk = buffer->first; chunk != NULL; chunk = chunk->next.load(memory_order_acquire))
+        {
+            int count = chunk->count.load(memory_order_acquire);
+            
+            for (int e = 0; e < count; ++e)
+            {
+                const tTraceEvent &event = chunk->events[e];
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}", event.name, event.type,
+                        process, buffer->thread, event.nanoseconds / 1000.0);
+            }
+        }
+    }
+    
+    fprintf(file, "\n]}\n");
+    
+    bool written = (fclose(file) == 0);
+    
+    if (!written || rename(temporaryName.c_str(), traceFileName.c_str()) != 0)
+    {
+        perror(traceFileName.c_str());
+        return false;
+    }
+    
+    return true;
+}
@@ -0,0 +1,76 @@
+/*
+ * tTrace.h
+ *
+ * This file is part of the Evolved Digit Detector project.
+ *
+ * Copyright 2014 Randal S. Olson.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _tTrace_h_included_
+#define _tTrace_h_included_
+
+#include <stdint.h>
+#include <atomic>
+
+using namespace std;
+
+// timeline of a run (-trace), written in the Chrome trace event format that
+// chrome://tracing and Perfetto read. every thread records begin and end
+// events into its own buffer without locking; the buffers are only walked
+// when the trace is written, at exit or when edd is sent SIGUSR2.
+
+extern atomic<bool> traceEnabled;
+
+void    traceRecord(const char *name, char type);
+void    traceStart(const char *fileName);
+void    traceSetThreadName(const char *name);
+void    traceService(void);
+bool    traceWrite(void);
+
+static inline void traceBegin(const char *name)
+{
+    if (traceEnabled.load(memory_order_relaxed))
+    {
+        traceRecord(name, 'B');
+    }
+}
+
+static inline void traceEnd(const char *name)
+{
+    if (traceEnabled.load(memory_order_relaxed))
+    {
+        traceRecord(name, 'E');
+    }
+}
+
+// traces the rest of the enclosing scope
+class tTraceScope
+{
+public:
+    tTraceScope(const char *name) : name(name) { traceBegin(name); }
+    ~tTraceScope() { traceEnd(name); }
+
+private:
+    const char *name;
+};
+
+#define TRACE_JOIN2(a, b)           a##b
+#define TRACE_JOIN(a, b)            TRACE_JOIN2(a, b)
+#define TRACE_SCOPE(name)           tTraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+#define TRACE_BEGIN(name)           traceBegin(name)
+#define TRACE_END(name)             traceEnd(name)
+
+#endif